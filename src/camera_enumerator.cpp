@@ -0,0 +1,138 @@
+#include "camera_enumerator.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+using namespace ml_cam;
+
+namespace {
+
+#if defined(__linux__)
+
+// Read device name from sysfs
+std::string readV4L2DeviceName(const std::string & node_name) {
+    std::ifstream name_file("/sys/class/video4linux/" + node_name + "/name");
+    std::string name;
+    std::getline(name_file, name);
+    return name;
+}
+
+// Ask the device node whether it can capture video.
+// Some nodes (e.g. UVC metadata nodes) cannot
+bool isV4L2CaptureDevice(const std::string & device_path) {
+    int fd = ::open(device_path.c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct v4l2_capability cap;
+    bool can_capture = false;
+    if (ioctl(fd, VIDIOC_QUERYCAP, &cap) == 0) {
+        __u32 caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+        can_capture = (caps & (V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_VIDEO_CAPTURE_MPLANE)) != 0;
+    }
+
+    ::close(fd);
+    return can_capture;
+}
+
+#endif  // __linux__
+
+}  // namespace
+
+CameraEnumerator::CameraEnumerator(int max_cams) : max_cams(max_cams) {}
+
+std::vector<CameraDevice> CameraEnumerator::listCandidates() {
+    std::vector<CameraDevice> devices;
+
+#if defined(__linux__)
+    const std::string prefix = "video";
+    std::error_code ec;
+    for (fs::directory_iterator it("/dev", ec), end; !ec && it != end; it.increment(ec)) {
+        std::string node_name = it->path().filename().string();
+        if (node_name.compare(0, prefix.size(), prefix) != 0 || node_name.size() == prefix.size() ||
+            !std::all_of(node_name.begin() + prefix.size(), node_name.end(),
+                         [](unsigned char c) { return std::isdigit(c) != 0; })) {
+            continue;
+        }
+
+        if (!isV4L2CaptureDevice(it->path().string())) {
+            continue;
+        }
+
+        CameraDevice device;
+        device.index = std::stoi(node_name.substr(prefix.size()));
+        device.name = readV4L2DeviceName(node_name);
+        devices.push_back(device);
+    }
+
+    std::sort(devices.begin(), devices.end(),
+              [](const CameraDevice & lhs, const CameraDevice & rhs) { return lhs.index < rhs.index; });
+#else
+    for (int i = 0; i < max_cams; ++i) {
+        devices.push_back({i, ""});
+    }
+#endif
+
+    return devices;
+}
+
+std::vector<CameraDevice> CameraEnumerator::probe(const std::vector<CameraDevice> & candidates, int in_use_index) {
+    std::vector<CameraDevice> devices;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+
+        // Opening a camera in use would fail
+        if (candidates[i].index == in_use_index) {
+            devices.push_back(candidates[i]);
+            continue;
+        }
+
+        cv::VideoCapture temp_camera(candidates[i].index);
+        bool fail = (!temp_camera.isOpened());
+        temp_camera.release();
+
+        // If we can open camera, add new camera to list
+        if (!fail) {
+            devices.push_back(candidates[i]);
+        }
+    }
+    return devices;
+}
+
+std::vector<CameraDevice> CameraEnumerator::enumerate(int in_use_index) {
+    std::vector<CameraDevice> devices = listCandidates();
+
+#if !defined(__linux__)
+    // No cheap way to know which indices are real cameras
+    devices = probe(devices, in_use_index);
+#endif
+
+    std::lock_guard<std::mutex> guard(mutex);
+    cached_devices = devices;
+    has_cache = true;
+    return devices;
+}
+
+bool CameraEnumerator::hasCache() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return has_cache;
+}
+
+std::vector<CameraDevice> CameraEnumerator::getCachedDevices() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return cached_devices;
+}
+
+void CameraEnumerator::invalidate() {
+    std::lock_guard<std::mutex> guard(mutex);
+    has_cache = false;
+    cached_devices.clear();
+}
@@ -0,0 +1,50 @@
+#if !defined(CAMERA_ENUMERATOR_H)
+#define CAMERA_ENUMERATOR_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "filesystem_include.h"
+
+namespace ml_cam {
+
+struct CameraDevice {
+    int index;         // Index to open with cv::VideoCapture
+    std::string name;  // Device name if known
+};
+
+// List camera devices.
+// On Linux, devices are listed cheaply by scanning /dev/video* and asking each
+// node for its capabilities, without opening a capture stream. Elsewhere,
+// indices 0..max_cams-1 are probed by opening them with cv::VideoCapture (slow).
+// The result is cached, and enumerate() is safe to call from a worker thread.
+class CameraEnumerator {
+   private:
+    int max_cams;
+
+    std::mutex mutex;
+    bool has_cache = false;
+    std::vector<CameraDevice> cached_devices;
+
+    // Candidate devices. Cheap
+    std::vector<CameraDevice> listCandidates();
+
+    // Keep only candidates which can be opened. Slow
+    std::vector<CameraDevice> probe(const std::vector<CameraDevice> & candidates, int in_use_index);
+
+   public:
+    CameraEnumerator(int max_cams = 5);
+
+    // List available cameras and update the cache.
+    // in_use_index: camera currently opened by us. It is kept without probing
+    std::vector<CameraDevice> enumerate(int in_use_index = -1);
+
+    bool hasCache();
+    std::vector<CameraDevice> getCachedDevices();
+    void invalidate();
+};
+
+}  // namespace ml_cam
+
+#endif  // CAMERA_ENUMERATOR_H
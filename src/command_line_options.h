@@ -0,0 +1,52 @@
+#if !defined(COMMAND_LINE_OPTIONS_H)
+#define COMMAND_LINE_OPTIONS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame_source.h"
+#include "photo_writer.h"
+
+namespace ml_cam {
+
+// Options read from the command line. Defaults are used for options not given
+struct CommandLineOptions {
+    // Source used instead of the camera (nullptr to use the camera)
+    std::shared_ptr<FrameSource> frame_source;
+
+    // Cameras processed next to the selected one
+    std::vector<int> extra_cameras;
+
+    PhotoEncoding photo_encoding;
+    std::string video_codec = "MJPG";
+
+    // Length and storage of the instant replay. 0 seconds disables it
+    double pre_roll_seconds = 5;
+    bool pre_roll_raw = false;
+
+    // Keep camera frames in their YUV layout
+    bool native_yuv = false;
+
+    // Face detector runs every N frames, or at most X times per second
+    // when detect_rate is above 0
+    int detect_every_frames = 10;
+    float detect_rate = 0;
+
+    // Run the detector in the pipeline instead of in background
+    bool sync_detection = false;
+
+    // Full scan interval of ROI detection (0 to disable)
+    int roi_full_scan_interval = 0;
+
+    // Threshold of motion gated detection (0 to disable)
+    float motion_threshold = 0;
+
+    // Tiled SSD detector
+    int ssd_tile_size = 600;
+    float ssd_tile_overlap = 0.25f;
+};
+
+}  // namespace ml_cam
+
+#endif  // COMMAND_LINE_OPTIONS_H
@@ -50,7 +50,11 @@ void Animation::setFPS(float fps) {
 
 void Animation::overlayImage(const cv::Mat& background, const cv::Mat& foreground,
                   cv::Mat& output, cv::Point2i location) {
-    background.copyTo(output);
+
+    // Blending in place (output is background) needs no copy of the frame
+    if (output.data != background.data) {
+        background.copyTo(output);
+    }
 
     // start at the row indicated by location, or at row 0 if location.y is
     // negative.
@@ -117,24 +121,41 @@ cv::Mat Animation::rotateImage(const cv::Mat & img, double angle) {
 
 // Apply animation into image at position cv::Rect rect
 void Animation::apply(cv::Mat& draw, int animation_width, int left,
-                      int bottom, double angle)  {
+                      int bottom, double angle, int cache_key)  {
     const cv::Mat& animation = getFrame();
 
-    float scale_factor = static_cast<float>(animation_width) / animation.cols;
-
-    // Optain the scaled animation
+    // Reuse the transformed animation of this face if nothing changed
     cv::Mat scaled_animation;
-    cv::resize(animation, scaled_animation, cv::Size(), scale_factor,
-               scale_factor);
+    std::map<int, CachedSprite>::iterator cached = sprite_cache.end();
+    if (cache_key >= 0) {
+        cached = sprite_cache.find(cache_key);
+    }
+    if (cached != sprite_cache.end() &&
+        cached->second.frame_index == current_frame_index &&
+        std::abs(cached->second.width - animation_width) <= 1 &&
+        std::abs(cached->second.angle - angle) < 1) {
+        scaled_animation = cached->second.sprite;
+    } else {
+        float scale_factor = static_cast<float>(animation_width) / animation.cols;
 
-    // Rotate
-    if (angle) {
-        scaled_animation = rotateImage(scaled_animation, angle);
+        // Optain the scaled animation
+        cv::resize(animation, scaled_animation, cv::Size(), scale_factor,
+                   scale_factor);
+
+        // Rotate
+        if (angle) {
+            scaled_animation = rotateImage(scaled_animation, angle);
+        }
+
+        if (cache_key >= 0) {
+            if (sprite_cache.size() >= MAX_CACHED_SPRITES) {
+                sprite_cache.clear();
+            }
+            sprite_cache[cache_key] = {current_frame_index, animation_width, angle, scaled_animation};
+        }
     }
 
-    // overlayImage(draw, scaled_animation, left, bottom);
-    cv::Mat result;
+    // Blend directly into draw. Only pixels under the animation change
     int y1 = bottom - scaled_animation.rows;
-    overlayImage(draw, scaled_animation, result, cv::Point2i(left, y1));
-    draw = result;
+    overlayImage(draw, scaled_animation, draw, cv::Point2i(left, y1));
 }
@@ -1,6 +1,7 @@
 #if !defined(ANIMATION_H)
 #define ANIMATION_H
 
+#include <map>
 #include <vector>
 #include <opencv2/opencv.hpp>
 #include "timer.h"
@@ -13,6 +14,17 @@ class Animation {
         size_t current_frame_index = 0; // Index of current frame in vector `frames`
         Timer::time_duration_t animation_frame_duration = 0; // Time to change animation
         Timer::time_point_t last_animation_time; // The last time the animation was changed
+
+        // Scaled and rotated animation frames of each face (by track ID),
+        // reused while the face keeps the same size and angle
+        struct CachedSprite {
+            size_t frame_index;
+            int width;
+            double angle;
+            cv::Mat sprite;
+        };
+        std::map<int, CachedSprite> sprite_cache;
+        const size_t MAX_CACHED_SPRITES = 16;
    public:
     Animation();
     ~Animation();
@@ -24,13 +36,15 @@ class Animation {
 
     // Code from: http://jepsonsblog.blogspot.com/2012/10/overlay-transparent-image-in-opencv.html
     // NOTE: background must be in BGR, foreground must be in GBRA format (png image)
+    // output may be background itself to blend in place
     void overlayImage(const cv::Mat& background, const cv::Mat& foreground,
                   cv::Mat& output, cv::Point2i location);
 
     cv::Mat rotateImage(const cv::Mat & img, double angle);
 
     // Apply animation into image at position cv::Rect rect
-    void apply(cv::Mat& draw, int animation_width, int left, int bottom, double angle = 0);
+    // cache_key: track ID of the face to cache the transformed animation for. -1 for no caching
+    void apply(cv::Mat& draw, int animation_width, int left, int bottom, double angle = 0, int cache_key = -1);
 
 };
 
@@ -24,7 +24,7 @@ void EffectCloud::apply(cv::Mat & draw, std::vector<LandMarkResult> & landmarks)
         int left = face.tl().x - (animation_width - face.width) / 2;
         int bottom = face.tl().y - face.width / 5;
 
-        cloud_animation.apply(draw, animation_width, left, bottom);
+        cloud_animation.apply(draw, animation_width, left, bottom, 0, landmarks[i].getTrackId());
     }
 
 }
\ No newline at end of file
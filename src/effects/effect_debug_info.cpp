@@ -11,6 +11,28 @@ void EffectDebugInfo::outputFPS(float detection_fps, float alignment_fps) {
     this->current_alignment_fps = alignment_fps;
 }
 
+void EffectDebugInfo::outputDroppedFrames(uint64_t capture_dropped_frames, uint64_t total_dropped_frames) {
+    this->capture_dropped_frames = capture_dropped_frames;
+    this->total_dropped_frames = total_dropped_frames;
+}
+
+void EffectDebugInfo::outputBufferPool(uint64_t reused_buffers, uint64_t allocated_buffers) {
+    this->reused_buffers = reused_buffers;
+    this->allocated_buffers = allocated_buffers;
+}
+
+void EffectDebugInfo::outputRecording(bool recording, size_t queue_depth, uint64_t dropped_frames) {
+    this->recording = recording;
+    this->recorder_queue_depth = queue_depth;
+    this->recorder_dropped_frames = dropped_frames;
+}
+
+void EffectDebugInfo::outputMotionGating(float skip_ratio, float partial_ratio) {
+    this->motion_gating = true;
+    this->detection_skip_ratio = skip_ratio;
+    this->partial_detection_ratio = partial_ratio;
+}
+
 void EffectDebugInfo::apply(cv::Mat& draw,
                             std::vector<LandMarkResult>& landmarks) {
     // Draw face bounding boxes and landmarks
@@ -59,6 +81,23 @@ void EffectDebugInfo::apply(cv::Mat& draw,
     ml_cam::setLabel(draw, std::string("Face Alignment FPS: ") +
             std::to_string(displayed_alignment_fps == 0 ? -1 : displayed_alignment_fps), cv::Point(10, 85));
 
+    ml_cam::setLabel(draw, std::string("Dropped Frames: ") +
+            std::to_string(total_dropped_frames) + " (capture: " + std::to_string(capture_dropped_frames) + ")", cv::Point(10, 105));
+
+    ml_cam::setLabel(draw, std::string("Frame Buffers: ") +
+            std::to_string(reused_buffers) + " reused, " + std::to_string(allocated_buffers) + " allocated", cv::Point(10, 125));
+
+    if (recording) {
+        ml_cam::setLabel(draw, std::string("Recording: ") +
+                std::to_string(recorder_queue_depth) + " queued, " + std::to_string(recorder_dropped_frames) + " dropped", cv::Point(10, 145));
+    }
+
+    if (motion_gating) {
+        ml_cam::setLabel(draw, std::string("Detections Skipped: ") +
+                std::to_string(static_cast<int>(detection_skip_ratio * 100)) + "% (partial: " +
+                std::to_string(static_cast<int>(partial_detection_ratio * 100)) + "%)", cv::Point(10, 165));
+    }
+
     
     last_draw_time = Timer::getCurrentTime();
             
@@ -20,11 +20,29 @@ class EffectDebugInfo : public ImageEffect {
     float current_detection_fps;
     float current_alignment_fps;
 
+    uint64_t capture_dropped_frames = 0; // Camera frames never processed
+    uint64_t total_dropped_frames = 0; // Frames dropped by capture and pipeline stages
+
+    uint64_t reused_buffers = 0; // Frame buffers taken from the pool (allocations avoided)
+    uint64_t allocated_buffers = 0; // Frame buffers the pool had to allocate
+
+    bool recording = false;
+    size_t recorder_queue_depth = 0; // Frames waiting for the video encoder
+    uint64_t recorder_dropped_frames = 0; // Frames the video encoder could not keep up with
+
+    bool motion_gating = false;
+    float detection_skip_ratio = 0; // Due detections skipped because the frame did not change
+    float partial_detection_ratio = 0; // Due detections run only on changed regions
+
    public:
     EffectDebugInfo();
     ~EffectDebugInfo();
 
     void outputFPS(float detection_fps, float alignment_fps);
+    void outputDroppedFrames(uint64_t capture_dropped_frames, uint64_t total_dropped_frames);
+    void outputBufferPool(uint64_t reused_buffers, uint64_t allocated_buffers);
+    void outputRecording(bool recording, size_t queue_depth, uint64_t dropped_frames);
+    void outputMotionGating(float skip_ratio, float partial_ratio);
 
     void apply(cv::Mat & draw, std::vector<LandMarkResult> & landmarks);
 };
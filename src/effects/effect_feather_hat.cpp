@@ -42,7 +42,7 @@ void EffectFeatherHat::apply(cv::Mat & draw, std::vector<LandMarkResult> & faces
             int left = left_point.x - (animation_width - eyes_width) / 2;
             int bottom = std::max(left_point.y, right_point.y) + eyes_width * 1.2;
 
-            feather_hat_animation.apply(draw, animation_width, left, bottom, angle); 
+            feather_hat_animation.apply(draw, animation_width, left, bottom, angle, faces[i].getTrackId()); 
 
         } else {
 
@@ -54,7 +54,7 @@ void EffectFeatherHat::apply(cv::Mat & draw, std::vector<LandMarkResult> & faces
             int left = face.tl().x - (animation_width - face.width) / 2;
             int bottom = face.br().y + face.height / 10;
 
-            feather_hat_animation.apply(draw, animation_width, left, bottom);
+            feather_hat_animation.apply(draw, animation_width, left, bottom, 0, faces[i].getTrackId());
 
         }
 
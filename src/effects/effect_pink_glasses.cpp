@@ -42,7 +42,7 @@ void EffectPinkGlasses::apply(cv::Mat & draw, std::vector<LandMarkResult> & face
             int left = left_point.x - (animation_width - eyes_width) / 2;
             int bottom = std::max(left_point.y, right_point.y) + eyes_width * 0.35;
 
-            pink_glasses_animation.apply(draw, animation_width, left, bottom, angle); 
+            pink_glasses_animation.apply(draw, animation_width, left, bottom, angle, faces[i].getTrackId()); 
 
             
         } else { // Otherwise, use only face bounding box
@@ -55,7 +55,7 @@ void EffectPinkGlasses::apply(cv::Mat & draw, std::vector<LandMarkResult> & face
             int left = face.tl().x - (animation_width - face.width) / 2;
             int bottom = face.tl().y + animation_width * 0.6;
 
-            pink_glasses_animation.apply(draw, animation_width, left, bottom); 
+            pink_glasses_animation.apply(draw, animation_width, left, bottom, 0, faces[i].getTrackId()); 
         }
 
     }
@@ -22,7 +22,7 @@ void EffectRabbitEars::apply(cv::Mat & draw, std::vector<LandMarkResult> & landm
         int left = face.tl().x - (animation_width - face.width) / 2;
         int bottom = face.tl().y + animation_width * 0.16;
 
-        rabbit_ears_animation.apply(draw, animation_width, left, bottom); 
+        rabbit_ears_animation.apply(draw, animation_width, left, bottom, 0, landmarks[i].getTrackId()); 
     }
 
 }
@@ -22,7 +22,7 @@ void EffectTiger::apply(cv::Mat & draw, std::vector<LandMarkResult> & landmarks)
         int left = face.tl().x - (animation_width - face.width) / 2;
         int bottom = face.br().y + animation_width * 0.16;
 
-        tiger_animation.apply(draw, animation_width, left, bottom); 
+        tiger_animation.apply(draw, animation_width, left, bottom, 0, landmarks[i].getTrackId()); 
     }
 
 }
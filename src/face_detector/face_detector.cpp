@@ -1,4 +1,7 @@
 #include "face_detector.h"
+#include <algorithm>
+#include <cmath>
+#include "utility.h"
 
 FaceDetector::FaceDetector() {}
 FaceDetector::~FaceDetector() {}
@@ -9,4 +12,120 @@ std::string FaceDetector::getDetectorName() {
 }
 void FaceDetector::setDetectorName(std::string detector_name) {
     this->detector_name = detector_name;
-}
\ No newline at end of file
+}
+
+std::vector<LandMarkResult> FaceDetector::detect(const cv::Mat & img) {
+    ml_cam::FrameContext context(img);
+    return detect(context);
+}
+
+bool FaceDetector::supportsROI() {
+    return false;
+}
+
+std::vector<LandMarkResult> FaceDetector::detectInROI(ml_cam::FrameContext & context, const cv::Rect & roi,
+                                                      const cv::Size & min_face_size, const cv::Size & max_face_size) {
+    return std::vector<LandMarkResult>();
+}
+
+std::vector<LandMarkResult> FaceDetector::detectAround(ml_cam::FrameContext & context,
+                                                       const std::vector<cv::Rect> & known_faces) {
+    if (!supportsROI() || known_faces.empty()) {
+        return detect(context);
+    }
+
+    cv::Rect frame_rect(cv::Point(0, 0), context.getSize());
+    std::vector<LandMarkResult> results;
+    for (size_t i = 0; i < known_faces.size(); ++i) {
+        const cv::Rect & face = known_faces[i];
+        int face_size = std::max(face.width, face.height);
+        int padding = static_cast<int>(face_size * ROI_PADDING);
+        cv::Rect roi = cv::Rect(face.x - padding, face.y - padding,
+                                face.width + 2 * padding, face.height + 2 * padding) & frame_rect;
+        if (roi.empty()) {
+            continue;
+        }
+
+        int min_size = static_cast<int>(face_size * MIN_ROI_FACE_SCALE);
+        int max_size = static_cast<int>(std::ceil(face_size * MAX_ROI_FACE_SCALE));
+        std::vector<LandMarkResult> found = detectInROI(context, roi, cv::Size(min_size, min_size),
+                                                        cv::Size(max_size, max_size));
+
+        // ROIs of close faces overlap. Keep only one box per face
+        for (size_t j = 0; j < found.size(); ++j) {
+            bool duplicate = false;
+            for (size_t k = 0; k < results.size() && !duplicate; ++k) {
+                duplicate = ml_cam::calcIoU(found[j].getFaceRect(), results[k].getFaceRect()) > 0.5f;
+            }
+            if (!duplicate) {
+                results.push_back(found[j]);
+            }
+        }
+    }
+
+    return results;
+}
+
+std::vector<LandMarkResult> FaceDetector::detectInRegions(ml_cam::FrameContext & context,
+                                                          const std::vector<cv::Rect> & regions,
+                                                          const std::vector<LandMarkResult> & previous_faces) {
+    if (!supportsROI() || regions.empty()) {
+        return detect(context);
+    }
+
+    cv::Rect frame_rect(cv::Point(0, 0), context.getSize());
+    std::vector<LandMarkResult> results;
+    std::vector<bool> replaced(previous_faces.size(), false);
+    for (size_t i = 0; i < regions.size(); ++i) {
+        cv::Rect roi = regions[i];
+        for (size_t j = 0; j < previous_faces.size(); ++j) {
+            cv::Rect face = previous_faces[j].getFaceRect();
+            if ((face & regions[i]).area() > 0) {
+                int padding = static_cast<int>(std::max(face.width, face.height) * ROI_PADDING);
+                roi |= cv::Rect(face.x - padding, face.y - padding,
+                                face.width + 2 * padding, face.height + 2 * padding);
+                replaced[j] = true;
+            }
+        }
+        roi &= frame_rect;
+        if (roi.empty()) {
+            continue;
+        }
+
+        std::vector<LandMarkResult> found = detectInROI(context, roi, cv::Size(), cv::Size());
+        for (size_t j = 0; j < found.size(); ++j) {
+            bool duplicate = false;
+            for (size_t k = 0; k < results.size() && !duplicate; ++k) {
+                duplicate = ml_cam::calcIoU(found[j].getFaceRect(), results[k].getFaceRect()) > 0.5f;
+            }
+            if (!duplicate) {
+                results.push_back(found[j]);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < previous_faces.size(); ++i) {
+        if (!replaced[i]) {
+            results.push_back(previous_faces[i]);
+        }
+    }
+
+    return results;
+}
+
+std::vector<LandMarkResult> FaceDetector::detectInScope(ml_cam::FrameContext & context,
+                                                        const DetectionScope & scope) {
+    if (!scope.changed_regions.empty()) {
+        return detectInRegions(context, scope.changed_regions, scope.previous_faces);
+    }
+    return detectAround(context, scope.known_faces);
+}
+
+void FaceDetector::warmUp() {
+    cv::Mat dummy(300, 300, CV_8UC3, cv::Scalar::all(127));
+    detect(dummy);
+}
+
+std::shared_ptr<FaceDetector> FaceDetector::clone() {
+    return nullptr;
+}
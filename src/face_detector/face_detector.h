@@ -1,19 +1,87 @@
 #ifndef FACE_DETECTOR_H
 #define FACE_DETECTOR_H
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include "opencv2/opencv.hpp"
 #include "landmark_result.h"
+#include "frame_context.h"
 #include "filesystem_include.h"
 
+// Part of a frame one detector run searches (empty scope is the whole frame),
+// and what is known about the stream from earlier runs. One detector
+// instance serves many streams, so per-stream state is kept by the caller
+struct DetectionScope {
+    // Search only around these face boxes (see FaceDetector::detectAround)
+    std::vector<cv::Rect> known_faces;
+
+    // Search only inside these regions (e.g. where the frame changed).
+    // Previous faces outside them are kept (see FaceDetector::detectInRegions)
+    std::vector<cv::Rect> changed_regions;
+
+    // Faces of the last detector run on the same stream
+    std::vector<LandMarkResult> previous_faces;
+
+    // Number of earlier detector runs on the same stream
+    uint64_t run_count = 0;
+};
+
 class FaceDetector {
 private:
     std::string detector_name;
+
+protected:
+    // Region of interest around a known face is the face box grown by this
+    // ratio of its size on every side. Faces between MIN_ROI_FACE_SCALE and
+    // MAX_ROI_FACE_SCALE times the known face size are searched in it
+    const float ROI_PADDING = 0.5f;
+    const float MIN_ROI_FACE_SCALE = 0.6f;
+    const float MAX_ROI_FACE_SCALE = 1.6f;
+
+    // True if the detector implements detectInROI()
+    virtual bool supportsROI();
+
+    // Detect faces of size between min_face_size and max_face_size inside roi
+    // (empty size for no bound). Returned face boxes are in frame coordinates
+    virtual std::vector<LandMarkResult> detectInROI(ml_cam::FrameContext & context, const cv::Rect & roi,
+                                                    const cv::Size & min_face_size, const cv::Size & max_face_size);
+
 public:
     FaceDetector();
     ~FaceDetector();
 
-    virtual std::vector<LandMarkResult> detect(const cv::Mat & img) = 0;
+    // Detect faces on the frame of context. Derived images (gray, blob...)
+    // are taken from context, so they are shared with other detectors
+    virtual std::vector<LandMarkResult> detect(ml_cam::FrameContext & context) = 0;
+    std::vector<LandMarkResult> detect(const cv::Mat & img);
+
+    // Detect faces only around known faces (e.g. faces of the last frame),
+    // so the cost scales with face area instead of frame area.
+    // New faces elsewhere are not found: run detect() on the whole frame
+    // from time to time. Without known faces, or for detectors without
+    // ROI support, the whole frame is scanned
+    virtual std::vector<LandMarkResult> detectAround(ml_cam::FrameContext & context,
+                                                     const std::vector<cv::Rect> & known_faces);
+
+    // Detect faces again only inside regions, and keep the previous faces
+    // which do not touch any region. Regions are grown to contain the whole
+    // previous faces they touch. Detectors without ROI support scan the whole frame
+    virtual std::vector<LandMarkResult> detectInRegions(ml_cam::FrameContext & context,
+                                                        const std::vector<cv::Rect> & regions,
+                                                        const std::vector<LandMarkResult> & previous_faces);
+
+    // Run detectInRegions(), detectAround() or detect() depending on scope
+    virtual std::vector<LandMarkResult> detectInScope(ml_cam::FrameContext & context, const DetectionScope & scope);
+
+    // Run one dummy detection. The first inference of some models
+    // (e.g. cv::dnn::Net::forward) is much slower than later ones
+    virtual void warmUp();
+
+    // New instance of the same model, used by another thread.
+    // Read-only model data is shared with this instance where the backend allows it.
+    // Return nullptr if the model cannot be cloned
+    virtual std::shared_ptr<FaceDetector> clone();
     std::string getDetectorName();
     void setDetectorName(std::string);
 
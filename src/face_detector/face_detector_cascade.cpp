@@ -1,24 +1,49 @@
 #include "face_detector_cascade.h"
 
-FaceDetectorCascade::FaceDetectorCascade(std::string detector_name, std::string model_path) {
+FaceDetectorCascade::FaceDetectorCascade(std::string detector_name, std::string model_path)
+    : model_path(model_path) {
     setDetectorName(detector_name);
     fs::path FACE_CASCADE_PATH_ABS = fs::absolute(model_path);
     if( !face_cascade.load(FACE_CASCADE_PATH_ABS.string()) ) {
         std::cout << "Cannot Open Haar Cascade model: " << FACE_CASCADE_PATH_ABS << std::endl;
         exit(-1);
     }
+    model_buffer = ml_cam::readFileBuffer(FACE_CASCADE_PATH_ABS.string());
+}
+
+// cv::CascadeClassifier is not reentrant, so every instance needs its own.
+// It is parsed from the model file already in memory
+FaceDetectorCascade::FaceDetectorCascade(const FaceDetectorCascade & other)
+    : FaceDetector(other), model_path(other.model_path), model_buffer(other.model_buffer) {
+
+    bool loaded = false;
+    if (model_buffer) {
+        std::string model_data(model_buffer->begin(), model_buffer->end());
+        cv::FileStorage model_fs(model_data, cv::FileStorage::READ | cv::FileStorage::MEMORY);
+        loaded = model_fs.isOpened() && face_cascade.read(model_fs.getFirstTopLevelNode());
+    }
+
+    // Cascades in the old format can only be loaded from file
+    if (!loaded && !face_cascade.load(fs::absolute(model_path).string())) {
+        std::cout << "Cannot Open Haar Cascade model: " << fs::absolute(model_path) << std::endl;
+        exit(-1);
+    }
+}
+
+std::shared_ptr<FaceDetector> FaceDetectorCascade::clone() {
+    return std::shared_ptr<FaceDetector>(new FaceDetectorCascade(*this));
 }
 
 FaceDetectorCascade::~FaceDetectorCascade() {
 }
 
 
-std::vector<LandMarkResult> FaceDetectorCascade::detect(const cv::Mat & img) {
+std::vector<LandMarkResult> FaceDetectorCascade::detect(ml_cam::FrameContext & context) {
 
-    cv::Mat gray;
-    
-    // Convert image to gray (we only need grayscale image in this detector)
-    cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+    const cv::Size img_size = context.getSize();
+
+    // We only need grayscale image in this detector (Y plane of YUV frames, no conversion)
+    cv::Mat gray = context.getGray();
 
     // Detect face using loaded model
     std::vector<cv::Rect> faces;
@@ -30,8 +55,8 @@ std::vector<LandMarkResult> FaceDetectorCascade::detect(const cv::Mat & img) {
 
         // Put face into the result only if face does not go out of the boundary of image.
         // This prevent false positive for OpenCV HaarCascade and ResNet10 face detector
-        if ( 0 <= faces[i].x && 0 <= faces[i].width && faces[i].x + faces[i].width <= img.cols
-        && 0 <= faces[i].y && 0 <= faces[i].height && faces[i].y + faces[i].height <= img.rows) {
+        if ( 0 <= faces[i].x && 0 <= faces[i].width && faces[i].x + faces[i].width <= img_size.width
+        && 0 <= faces[i].y && 0 <= faces[i].height && faces[i].y + faces[i].height <= img_size.height) {
             LandMarkResult landmark;
             landmark.setFaceRect(faces[i]);
             landmark_results.push_back(landmark);
@@ -41,4 +66,28 @@ std::vector<LandMarkResult> FaceDetectorCascade::detect(const cv::Mat & img) {
 
     return landmark_results;
 
-}
\ No newline at end of file
+}
+
+bool FaceDetectorCascade::supportsROI() {
+    return true;
+}
+
+std::vector<LandMarkResult> FaceDetectorCascade::detectInROI(ml_cam::FrameContext & context, const cv::Rect & roi,
+                                                             const cv::Size & min_face_size, const cv::Size & max_face_size) {
+
+    // Only the gray pixels of the ROI are converted (unless the whole gray frame exists)
+    cv::Mat gray = context.getGrayCrop(roi);
+
+    // Size bounds skip the scales which cannot contain the known face
+    std::vector<cv::Rect> faces;
+    face_cascade.detectMultiScale(gray, faces, 1.1, 3, 0, min_face_size, max_face_size);
+
+    std::vector <LandMarkResult> landmark_results;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        LandMarkResult landmark;
+        landmark.setFaceRect(faces[i] + roi.tl());
+        landmark_results.push_back(landmark);
+    }
+
+    return landmark_results;
+}
@@ -2,17 +2,31 @@
 #define FACE_DETECTOR_CASCADE_H
 
 #include "face_detector.h"
+#include "utility.h"
 #include <string>
 #include <iostream>
 
 class FaceDetectorCascade : public FaceDetector {
 private:
     cv::CascadeClassifier face_cascade;
+    std::string model_path;
+
+    // Model file is read once and shared by all clones
+    std::shared_ptr<const std::vector<uchar>> model_buffer;
+
+protected:
+    bool supportsROI();
+    std::vector<LandMarkResult> detectInROI(ml_cam::FrameContext & context, const cv::Rect & roi,
+                                            const cv::Size & min_face_size, const cv::Size & max_face_size);
+
 public:
     FaceDetectorCascade(std::string detector_name, std::string model_path);
+    FaceDetectorCascade(const FaceDetectorCascade & other);
     ~FaceDetectorCascade();
 
-    std::vector<LandMarkResult> detect(const cv::Mat & img);
+    std::shared_ptr<FaceDetector> clone();
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context);
 };
 
 
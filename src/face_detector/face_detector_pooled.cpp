@@ -0,0 +1,62 @@
+#include "face_detector_pooled.h"
+
+FaceDetectorPooled::FaceDetectorPooled(std::shared_ptr<ml_cam::ModelPool<FaceDetector>> pool)
+    : pool(pool) {
+    ml_cam::ModelPool<FaceDetector>::Lease detector = pool->checkout();
+    if (detector) {
+        setDetectorName(detector->getDetectorName());
+    }
+}
+
+FaceDetectorPooled::~FaceDetectorPooled() {}
+
+std::vector<LandMarkResult> FaceDetectorPooled::detect(ml_cam::FrameContext & context) {
+    ml_cam::ModelPool<FaceDetector>::Lease detector = pool->checkout();
+    if (!detector) {
+        return std::vector<LandMarkResult>();
+    }
+    return detector->detect(context);
+}
+
+std::vector<LandMarkResult> FaceDetectorPooled::detectAround(ml_cam::FrameContext & context,
+                                                             const std::vector<cv::Rect> & known_faces) {
+    ml_cam::ModelPool<FaceDetector>::Lease detector = pool->checkout();
+    if (!detector) {
+        return std::vector<LandMarkResult>();
+    }
+    return detector->detectAround(context, known_faces);
+}
+
+std::vector<LandMarkResult> FaceDetectorPooled::detectInRegions(ml_cam::FrameContext & context,
+                                                                const std::vector<cv::Rect> & regions,
+                                                                const std::vector<LandMarkResult> & previous_faces) {
+    ml_cam::ModelPool<FaceDetector>::Lease detector = pool->checkout();
+    if (!detector) {
+        return std::vector<LandMarkResult>();
+    }
+    return detector->detectInRegions(context, regions, previous_faces);
+}
+
+std::vector<LandMarkResult> FaceDetectorPooled::detectInScope(ml_cam::FrameContext & context,
+                                                              const DetectionScope & scope) {
+    ml_cam::ModelPool<FaceDetector>::Lease detector = pool->checkout();
+    if (!detector) {
+        return std::vector<LandMarkResult>();
+    }
+    return detector->detectInScope(context, scope);
+}
+
+void FaceDetectorPooled::warmUp() {
+    ml_cam::ModelPool<FaceDetector>::Lease detector = pool->checkout();
+    if (detector) {
+        detector->warmUp();
+    }
+}
+
+std::shared_ptr<FaceDetector> FaceDetectorPooled::clone() {
+    return std::make_shared<FaceDetectorPooled>(pool);
+}
+
+std::shared_ptr<ml_cam::ModelPool<FaceDetector>> FaceDetectorPooled::getPool() {
+    return pool;
+}
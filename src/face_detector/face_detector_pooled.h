@@ -0,0 +1,33 @@
+#ifndef FACE_DETECTOR_POOLED_H
+#define FACE_DETECTOR_POOLED_H
+
+#include <memory>
+#include "face_detector.h"
+#include "model_pool.h"
+
+// Face detector which can be shared by several threads (e.g. the pipelines
+// of several cameras). Every call checks out an instance from a pool of the
+// same model, so instances are never used by two threads at once
+class FaceDetectorPooled : public FaceDetector {
+private:
+    std::shared_ptr<ml_cam::ModelPool<FaceDetector>> pool;
+public:
+    FaceDetectorPooled(std::shared_ptr<ml_cam::ModelPool<FaceDetector>> pool);
+    ~FaceDetectorPooled();
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context);
+    std::vector<LandMarkResult> detectAround(ml_cam::FrameContext & context,
+                                             const std::vector<cv::Rect> & known_faces);
+    std::vector<LandMarkResult> detectInRegions(ml_cam::FrameContext & context,
+                                                const std::vector<cv::Rect> & regions,
+                                                const std::vector<LandMarkResult> & previous_faces);
+    std::vector<LandMarkResult> detectInScope(ml_cam::FrameContext & context, const DetectionScope & scope);
+    void warmUp();
+
+    // The pooled detector is already thread-safe. Clones share its pool
+    std::shared_ptr<FaceDetector> clone();
+
+    std::shared_ptr<ml_cam::ModelPool<FaceDetector>> getPool();
+};
+
+#endif
@@ -1,30 +1,259 @@
 #include "face_detector_ssd_resnet10.h"
+#include <algorithm>
 
 FaceDetectorSSDResNet10::FaceDetectorSSDResNet10() {
     setDetectorName("SSD ResNet10");
     fs::path TENSORFLOW_WEIGHT_FILE_PATH_ABS = fs::absolute(TENSORFLOW_WEIGHT_FILE);
     fs::path TENSORFLOW_CONFIG_FILE_PATH_ABS = fs::absolute(TENSORFLOW_CONFIG_FILE);
-    face_model = cv::dnn::readNetFromTensorflow(TENSORFLOW_WEIGHT_FILE_PATH_ABS.string(), TENSORFLOW_CONFIG_FILE_PATH_ABS.string());
+    weight_buffer = ml_cam::readFileBuffer(TENSORFLOW_WEIGHT_FILE_PATH_ABS.string());
+    config_buffer = ml_cam::readFileBuffer(TENSORFLOW_CONFIG_FILE_PATH_ABS.string());
+    if (!weight_buffer || !config_buffer) {
+        std::cout << "Cannot Open SSD ResNet10 model: " << TENSORFLOW_WEIGHT_FILE_PATH_ABS << std::endl;
+        exit(-1);
+    }
+    face_model = cv::dnn::readNetFromTensorflow(*weight_buffer, *config_buffer);
+}
+
+// Every instance needs its own network (cv::dnn::Net is not thread-safe),
+// but it is built from the model files already in memory.
+// Tile workers are not copied (see clone())
+FaceDetectorSSDResNet10::FaceDetectorSSDResNet10(const FaceDetectorSSDResNet10 & other)
+    : FaceDetector(other), weight_buffer(other.weight_buffer), config_buffer(other.config_buffer),
+      tile_size(other.tile_size), tile_overlap(other.tile_overlap), max_frame_size(other.max_frame_size) {
+    face_model = cv::dnn::readNetFromTensorflow(*weight_buffer, *config_buffer);
+}
+
+std::shared_ptr<FaceDetector> FaceDetectorSSDResNet10::clone() {
+    std::shared_ptr<FaceDetectorSSDResNet10> detector(new FaceDetectorSSDResNet10(*this));
+    detector->createTileWorkers();
+    return detector;
 }
 
 FaceDetectorSSDResNet10::~FaceDetectorSSDResNet10() {
 }
 
 
-std::vector<LandMarkResult> FaceDetectorSSDResNet10::detect(const cv::Mat & img) {
+std::vector<LandMarkResult> FaceDetectorSSDResNet10::detect(ml_cam::FrameContext & context) {
 
-    // Detection results;
-    std::vector <LandMarkResult> landmark_results; 
+    if (isTiled(context.getSize(), tile_size)) {
+        return detectTiled(context);
+    }
+
+    // Whole frame is squeezed into 300x300
+    cv::Mat input_blob = context.getBlob(cv::Size(300, 300), 1.0, MEAN_VAL, true);
+    return runNetwork(input_blob, cv::Rect(cv::Point(0, 0), context.getSize()), context.getSize());
+}
+
+void FaceDetectorSSDResNet10::warmUp() {
+    FaceDetector::warmUp();
+    if (tile_workers.empty()) {
+        return;
+    }
+
+    // The first run on an input size is slow. Workers get tiles and the
+    // whole frame input, and this detector also gets tiles
+    cv::Mat tile(tile_size, tile_size, CV_8UC3, cv::Scalar::all(127));
+    cv::Mat tile_blob = getCropBlob(tile, cv::Rect(0, 0, tile_size, tile_size));
+    cv::Mat full_blob = cv::dnn::blobFromImage(tile, 1.0, cv::Size(300, 300), MEAN_VAL, true, false);
+    cv::Rect area(0, 0, tile_size, tile_size);
+    runNetwork(tile_blob, area, tile.size());
+    for (size_t i = 0; i < tile_workers.size(); ++i) {
+        tile_workers[i]->runNetwork(tile_blob, area, tile.size());
+        tile_workers[i]->runNetwork(full_blob, area, tile.size());
+    }
+}
+
+bool FaceDetectorSSDResNet10::supportsROI() {
+    return true;
+}
+
+std::vector<LandMarkResult> FaceDetectorSSDResNet10::detectInROI(ml_cam::FrameContext & context, const cv::Rect & roi,
+                                                                 const cv::Size & min_face_size, const cv::Size & max_face_size) {
+
+    std::vector<LandMarkResult> faces = runNetwork(getCropBlob(context.getImage(), roi), roi, context.getSize());
+
+    // Network has no size bounds. Drop boxes outside them (empty size is no bound)
+    std::vector<LandMarkResult> landmark_results;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        cv::Rect face = faces[i].getFaceRect();
+        int face_size = std::max(face.width, face.height);
+        if ((min_face_size.area() > 0 && face_size < std::max(min_face_size.width, min_face_size.height)) ||
+            (max_face_size.area() > 0 && face_size > std::max(max_face_size.width, max_face_size.height))) {
+            continue;
+        }
+        landmark_results.push_back(faces[i]);
+    }
+    return landmark_results;
+}
+
+cv::Mat FaceDetectorSSDResNet10::getCropBlob(const cv::Mat & image, const cv::Rect & crop) {
+    // Crop is not squeezed, so small faces keep their pixels
+    double scale = std::min(1.0, static_cast<double>(MAX_ROI_INPUT_SIZE) / std::max(crop.width, crop.height));
+    cv::Size input_size(cvRound(crop.width * scale), cvRound(crop.height * scale));
+    return cv::dnn::blobFromImage(image(crop), 1.0, input_size, MEAN_VAL, true, false);
+}
+
+void FaceDetectorSSDResNet10::setTiling(int tile_size, float tile_overlap, const cv::Size & max_frame_size) {
+    this->tile_size = std::max(0, tile_size);
+    this->tile_overlap = std::max(0.0f, std::min(0.9f, tile_overlap));
+    this->max_frame_size = max_frame_size;
+    createTileWorkers();
+}
+
+size_t FaceDetectorSSDResNet10::getNetworkCount(int tile_size, float tile_overlap, const cv::Size & max_frame_size) {
+    if (!isTiled(max_frame_size, tile_size)) {
+        return 1;
+    }
+    // Tiles and the whole frame pass
+    size_t tile_count = getTiles(max_frame_size, tile_size, tile_overlap).size() + 1;
+    return std::min(tile_count, static_cast<size_t>(std::max(1, cv::getNumThreads())));
+}
+
+void FaceDetectorSSDResNet10::createTileWorkers() {
+    // This detector is one of the workers
+    size_t worker_count = getNetworkCount(tile_size, tile_overlap, max_frame_size) - 1;
+    tile_workers.clear();
+    for (size_t i = 0; i < worker_count; ++i) {
+        tile_workers.push_back(std::make_shared<FaceDetectorSSDResNet10>(*this));
+    }
+}
+
+bool FaceDetectorSSDResNet10::isTiled(const cv::Size & img_size, int tile_size) {
+    // With less than 2 tiles along both sides, tiles overlap mostly and cost more than they find
+    return tile_size > 0 && (img_size.width >= 2 * tile_size || img_size.height >= 2 * tile_size);
+}
 
-    const float confidence_threshold = 0.7f;
-    const cv::Scalar mean_val(104.0, 177.0, 123.0);
+std::vector<cv::Rect> FaceDetectorSSDResNet10::getTiles(const cv::Size & img_size, int tile_size, float tile_overlap) {
+    int step = std::max(1, static_cast<int>(tile_size * (1 - tile_overlap)));
+    int tile_width = std::min(tile_size, img_size.width);
+    int tile_height = std::min(tile_size, img_size.height);
 
-    // Detect face using loaded model
-    std::vector<cv::Rect> faces;
-    
-    int frame_width = img.cols;
-    int frame_height = img.rows;
-    cv::Mat input_blob = cv::dnn::blobFromImage(img, 1.0, cv::Size(300, 300), mean_val, true, false);
+    // Tile origins along one side. The last tile ends at the frame border
+    auto getOrigins = [step](int length, int tile) {
+        std::vector<int> origins;
+        for (int x = 0; x + tile < length; x += step) {
+            origins.push_back(x);
+        }
+        origins.push_back(length - tile);
+        return origins;
+    };
+
+    std::vector<int> xs = getOrigins(img_size.width, tile_width);
+    std::vector<int> ys = getOrigins(img_size.height, tile_height);
+    std::vector<cv::Rect> tiles;
+    for (size_t i = 0; i < ys.size(); ++i) {
+        for (size_t j = 0; j < xs.size(); ++j) {
+            tiles.push_back(cv::Rect(xs[j], ys[i], tile_width, tile_height));
+        }
+    }
+    return tiles;
+}
+
+std::vector<LandMarkResult> FaceDetectorSSDResNet10::detectTiled(ml_cam::FrameContext & context) {
+    const cv::Size img_size = context.getSize();
+    const cv::Rect frame_rect(cv::Point(0, 0), img_size);
+    std::vector<cv::Rect> tiles = getTiles(img_size, tile_size, tile_overlap);
+
+    // Whole frame squeezed into 300x300 finds faces bigger than a tile
+    tiles.push_back(frame_rect);
+
+    // One network per worker (cv::dnn::Net is not thread-safe). Worker 0 is this detector
+    std::vector<FaceDetectorSSDResNet10 *> workers(1, this);
+    for (size_t i = 0; i < tile_workers.size() && workers.size() < tiles.size(); ++i) {
+        workers.push_back(tile_workers[i].get());
+    }
+
+    // Converted once, before the workers read it
+    const cv::Mat & image = context.getImage();
+    cv::Mat full_blob = context.getBlob(cv::Size(300, 300), 1.0, MEAN_VAL, true);
+
+    // Worker w runs tiles w, w + worker_count, ...
+    std::vector<std::vector<LandMarkResult>> tile_faces(tiles.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(workers.size())), [&](const cv::Range & range) {
+        for (int w = range.start; w < range.end; w++) {
+            for (size_t i = w; i < tiles.size(); i += workers.size()) {
+                cv::Mat input_blob = tiles[i] == frame_rect ? full_blob : getCropBlob(image, tiles[i]);
+                tile_faces[i] = workers[w]->runNetwork(input_blob, tiles[i], img_size);
+            }
+        }
+    }, static_cast<double>(workers.size()));
+
+    // A face on an inner tile edge is cut by it. A face smaller than the
+    // overlap is also whole in the neighbouring tile. A bigger one is only
+    // found in parts, one per tile it crosses
+    std::vector<LandMarkResult> whole_faces;
+    std::vector<LandMarkResult> cut_faces;
+    for (size_t i = 0; i < tile_faces.size(); ++i) {
+        const cv::Rect & tile = tiles[i];
+        for (size_t j = 0; j < tile_faces[i].size(); ++j) {
+            cv::Rect face = tile_faces[i][j].getFaceRect();
+            if ((tile.x > 0 && face.x <= tile.x + TILE_EDGE_MARGIN) ||
+                (tile.y > 0 && face.y <= tile.y + TILE_EDGE_MARGIN) ||
+                (tile.br().x < img_size.width && face.br().x >= tile.br().x - TILE_EDGE_MARGIN) ||
+                (tile.br().y < img_size.height && face.br().y >= tile.br().y - TILE_EDGE_MARGIN)) {
+                cut_faces.push_back(tile_faces[i][j]);
+            } else {
+                whole_faces.push_back(tile_faces[i][j]);
+            }
+        }
+    }
+
+    // Parts inside a face found whole are dropped
+    std::vector<LandMarkResult> parts;
+    for (size_t i = 0; i < cut_faces.size(); ++i) {
+        cv::Rect part = cut_faces[i].getFaceRect();
+        bool contained = false;
+        for (size_t j = 0; j < whole_faces.size() && !contained; ++j) {
+            contained = (part & whole_faces[j].getFaceRect()).area() >= CONTAINED_RATIO * part.area();
+        }
+        if (!contained) {
+            parts.push_back(cut_faces[i]);
+        }
+    }
+
+    // Overlapping parts (of neighbouring tiles) are joined into one face
+    bool joined = true;
+    while (joined) {
+        joined = false;
+        for (size_t i = 0; i < parts.size() && !joined; ++i) {
+            for (size_t j = i + 1; j < parts.size(); ++j) {
+                cv::Rect a = parts[i].getFaceRect();
+                cv::Rect b = parts[j].getFaceRect();
+                if ((a & b).area() > 0) {
+                    parts[i].setFaceRect(a | b, std::max(parts[i].getFaceRectConfidence(),
+                                                         parts[j].getFaceRectConfidence()));
+                    parts.erase(parts.begin() + j);
+                    joined = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Faces in the overlap of tiles are found more than once
+    std::vector<LandMarkResult> faces = whole_faces;
+    faces.insert(faces.end(), parts.begin(), parts.end());
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confidences;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        boxes.push_back(faces[i].getFaceRect());
+        confidences.push_back(faces[i].getFaceRectConfidence());
+    }
+    std::vector<int> indices;
+    cv::dnn::NMSBoxes(boxes, confidences, CONFIDENCE_THRESHOLD, NMS_THRESHOLD, indices);
+
+    std::vector<LandMarkResult> landmark_results;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        landmark_results.push_back(faces[indices[i]]);
+    }
+    return landmark_results;
+}
+
+std::vector<LandMarkResult> FaceDetectorSSDResNet10::runNetwork(const cv::Mat & input_blob, const cv::Rect & area,
+                                                                const cv::Size & img_size) {
+
+    // Detection results;
+    std::vector <LandMarkResult> landmark_results; 
 
     face_model.setInput(input_blob, "data");
     cv::Mat detection = face_model.forward("detection_out");
@@ -35,20 +264,20 @@ std::vector<LandMarkResult> FaceDetectorSSDResNet10::detect(const cv::Mat & img)
     {
         float confidence = detectionMat.at<float>(i, 2);
 
-        if(confidence > confidence_threshold)
+        if(confidence > CONFIDENCE_THRESHOLD)
         {
-            int x1 = static_cast<int>(detectionMat.at<float>(i, 3) * frame_width);
-            int y1 = static_cast<int>(detectionMat.at<float>(i, 4) * frame_height);
-            int x2 = static_cast<int>(detectionMat.at<float>(i, 5) * frame_width);
-            int y2 = static_cast<int>(detectionMat.at<float>(i, 6) * frame_height);
+            int x1 = area.x + static_cast<int>(detectionMat.at<float>(i, 3) * area.width);
+            int y1 = area.y + static_cast<int>(detectionMat.at<float>(i, 4) * area.height);
+            int x2 = area.x + static_cast<int>(detectionMat.at<float>(i, 5) * area.width);
+            int y2 = area.y + static_cast<int>(detectionMat.at<float>(i, 6) * area.height);
 
             cv::Rect face(x1, y1, x2 - x1, y2 - y1);
             // Put face into the result only if face does not go out of the boundary of image.
             // This prevent false positive for OpenCV HaarCascade and ResNet10 face detector
-            if ( 0 <= face.x && 0 <= face.width && face.x + face.width <= img.cols
-            && 0 <= face.y && 0 <= face.height && face.y + face.height <= img.rows) {
+            if ( 0 <= face.x && 0 <= face.width && face.x + face.width <= img_size.width
+            && 0 <= face.y && 0 <= face.height && face.y + face.height <= img_size.height) {
                 LandMarkResult landmark;
-                landmark.setFaceRect(face);
+                landmark.setFaceRect(face, confidence);
                 landmark_results.push_back(landmark);
             }
 
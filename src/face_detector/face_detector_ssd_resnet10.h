@@ -4,6 +4,7 @@
 #include <iostream>
 #include <string>
 #include "face_detector.h"
+#include "utility.h"
 
 class FaceDetectorSSDResNet10 : public FaceDetector {
    private:
@@ -13,11 +14,71 @@ class FaceDetectorSSDResNet10 : public FaceDetector {
         "./models/detect_ssd_resnet10/opencv_face_detector_uint8.pb";
     cv::dnn::Net face_model;
 
+    // Model files are read once and shared by all clones
+    std::shared_ptr<const std::vector<uchar>> weight_buffer;
+    std::shared_ptr<const std::vector<uchar>> config_buffer;
+
+    const float CONFIDENCE_THRESHOLD = 0.7f;
+    const cv::Scalar MEAN_VAL = cv::Scalar(104.0, 177.0, 123.0);
+
+    // ROI crops are fed at native resolution, but at most this size
+    const int MAX_ROI_INPUT_SIZE = 600;
+
+    // Tiled detection: frames where at least 2 tiles of tile_size fit along a
+    // side are split into tiles overlapping by tile_overlap (ratio of tile size).
+    // 0 disables it
+    int tile_size = 0;
+    float tile_overlap = 0.25f;
+    cv::Size max_frame_size;  // Largest expected frame. Sets the number of tile workers
+    const float NMS_THRESHOLD = 0.4f;
+    const int TILE_EDGE_MARGIN = 2;  // Faces this close to an inner tile edge are cut by it
+    const float CONTAINED_RATIO = 0.7f;  // Part of a cut face inside a whole face to be the same face
+
+    // Tiles run in parallel, each extra worker on its own network.
+    // Created with the tiling settings, never while detecting
+    std::vector<std::shared_ptr<FaceDetectorSSDResNet10>> tile_workers;
+    void createTileWorkers();
+
+    // Blob of a crop of image at native resolution, but at most MAX_ROI_INPUT_SIZE
+    cv::Mat getCropBlob(const cv::Mat & image, const cv::Rect & crop);
+
+    // Run network on input_blob and convert its detections to face boxes.
+    // area is the part of the frame the blob was made from
+    std::vector<LandMarkResult> runNetwork(const cv::Mat & input_blob, const cv::Rect & area,
+                                           const cv::Size & img_size);
+
+    static bool isTiled(const cv::Size & img_size, int tile_size);
+    static std::vector<cv::Rect> getTiles(const cv::Size & img_size, int tile_size, float tile_overlap);
+    std::vector<LandMarkResult> detectTiled(ml_cam::FrameContext & context);
+
+   protected:
+    bool supportsROI();
+    std::vector<LandMarkResult> detectInROI(ml_cam::FrameContext & context, const cv::Rect & roi,
+                                            const cv::Size & min_face_size, const cv::Size & max_face_size);
+
    public:
     FaceDetectorSSDResNet10();
+    FaceDetectorSSDResNet10(const FaceDetectorSSDResNet10 & other);
     ~FaceDetectorSSDResNet10();
 
-    std::vector<LandMarkResult> detect(const cv::Mat& img);
+    std::shared_ptr<FaceDetector> clone();
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context);
+
+    // Also runs every tile worker, on a tile and on the whole frame input
+    void warmUp();
+
+    // Detect on overlapping tiles of tile_size x tile_size pixels (and on the
+    // whole frame squeezed, for big faces), so small faces of large frames
+    // are not lost in the 300x300 input. Boxes are merged by NMS.
+    // tile_size 0 disables tiling. One network per worker thread is built here,
+    // at most as many as max_frame_size has tiles
+    void setTiling(int tile_size, float tile_overlap = 0.25f,
+                   const cv::Size & max_frame_size = cv::Size(3840, 2160));
+
+    // Number of networks a detector with these tiling settings builds (1 without tiling)
+    static size_t getNetworkCount(int tile_size, float tile_overlap,
+                                  const cv::Size & max_frame_size = cv::Size(3840, 2160));
 };
 
 
@@ -0,0 +1,84 @@
+#include "face_detector_two_stage.h"
+#include <algorithm>
+#include "utility.h"
+
+FaceDetectorTwoStage::FaceDetectorTwoStage(std::string detector_name, std::shared_ptr<FaceDetector> proposer,
+                                           std::shared_ptr<FaceDetector> verifier, int full_pass_interval)
+    : proposer(proposer), verifier(verifier), full_pass_interval(std::max(1, full_pass_interval)) {
+    setDetectorName(detector_name);
+}
+
+FaceDetectorTwoStage::~FaceDetectorTwoStage() {
+}
+
+std::shared_ptr<FaceDetector> FaceDetectorTwoStage::clone() {
+    std::shared_ptr<FaceDetector> proposer_clone = proposer->clone();
+    std::shared_ptr<FaceDetector> verifier_clone = verifier->clone();
+    if (!proposer_clone || !verifier_clone) {
+        return nullptr;
+    }
+    return std::shared_ptr<FaceDetector>(new FaceDetectorTwoStage(
+        getDetectorName(), proposer_clone, verifier_clone, full_pass_interval));
+}
+
+std::vector<LandMarkResult> FaceDetectorTwoStage::detect(ml_cam::FrameContext & context) {
+    return verifier->detect(context);
+}
+
+std::vector<LandMarkResult> FaceDetectorTwoStage::detectInScope(ml_cam::FrameContext & context,
+                                                                const DetectionScope & scope) {
+    if (!scope.changed_regions.empty()) {
+        return detectInRegions(context, scope.changed_regions, scope.previous_faces);
+    }
+    if (!scope.known_faces.empty()) {
+        return detectAround(context, scope.known_faces);
+    }
+
+    // First run of a stream, and every full_pass_interval runs after it
+    if (scope.run_count % full_pass_interval == 0) {
+        return detect(context);
+    }
+
+    // Proposals of the fast detector, and the faces of the last run
+    std::vector<cv::Rect> proposals;
+    for (size_t i = 0; i < scope.previous_faces.size(); ++i) {
+        proposals.push_back(scope.previous_faces[i].getFaceRect());
+    }
+    std::vector<LandMarkResult> candidates = proposer->detect(context);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        cv::Rect candidate = candidates[i].getFaceRect();
+        bool duplicate = false;
+        for (size_t j = 0; j < proposals.size() && !duplicate; ++j) {
+            duplicate = ml_cam::calcIoU(candidate, proposals[j]) > 0.5f;
+        }
+        if (!duplicate) {
+            proposals.push_back(candidate);
+        }
+    }
+
+    // Nothing to verify. Faces the fast detector missed are found by the next full pass
+    if (proposals.empty()) {
+        return std::vector<LandMarkResult>();
+    }
+    if (proposals.size() > MAX_PROPOSALS) {
+        return detect(context);
+    }
+
+    return verifier->detectAround(context, proposals);
+}
+
+std::vector<LandMarkResult> FaceDetectorTwoStage::detectAround(ml_cam::FrameContext & context,
+                                                               const std::vector<cv::Rect> & known_faces) {
+    return verifier->detectAround(context, known_faces);
+}
+
+std::vector<LandMarkResult> FaceDetectorTwoStage::detectInRegions(ml_cam::FrameContext & context,
+                                                                  const std::vector<cv::Rect> & regions,
+                                                                  const std::vector<LandMarkResult> & previous_faces) {
+    return verifier->detectInRegions(context, regions, previous_faces);
+}
+
+void FaceDetectorTwoStage::warmUp() {
+    proposer->warmUp();
+    verifier->warmUp();
+}
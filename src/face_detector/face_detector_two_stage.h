@@ -0,0 +1,45 @@
+#ifndef FACE_DETECTOR_TWO_STAGE_H
+#define FACE_DETECTOR_TWO_STAGE_H
+
+#include <memory>
+#include <string>
+#include "face_detector.h"
+
+// Two-stage detector: a fast detector (e.g. a cascade) proposes face boxes,
+// and an accurate detector (e.g. SSD) verifies them on padded crops around
+// the proposals only. Faces of the last run (DetectionScope::previous_faces)
+// are proposed again, so a face the fast detector misses for a frame is not lost.
+// The accurate detector scans the whole frame every full_pass_interval runs
+// of a stream (DetectionScope::run_count) to find faces the fast detector
+// does not propose at all. The detector keeps no state between runs, so one
+// instance can serve several streams.
+class FaceDetectorTwoStage : public FaceDetector {
+private:
+    std::shared_ptr<FaceDetector> proposer;
+    std::shared_ptr<FaceDetector> verifier;
+    int full_pass_interval;
+
+    // With more proposals, verifying every crop costs more than one full pass
+    const size_t MAX_PROPOSALS = 8;
+
+public:
+    FaceDetectorTwoStage(std::string detector_name, std::shared_ptr<FaceDetector> proposer,
+                         std::shared_ptr<FaceDetector> verifier, int full_pass_interval = 10);
+    ~FaceDetectorTwoStage();
+
+    std::shared_ptr<FaceDetector> clone();
+
+    // Without a scope, the whole frame is scanned by the accurate detector
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context);
+
+    // Known faces are verified directly, without proposals
+    std::vector<LandMarkResult> detectAround(ml_cam::FrameContext & context,
+                                             const std::vector<cv::Rect> & known_faces);
+    std::vector<LandMarkResult> detectInRegions(ml_cam::FrameContext & context,
+                                                const std::vector<cv::Rect> & regions,
+                                                const std::vector<LandMarkResult> & previous_faces);
+    std::vector<LandMarkResult> detectInScope(ml_cam::FrameContext & context, const DetectionScope & scope);
+    void warmUp();
+};
+
+#endif
@@ -9,4 +9,20 @@ std::string FaceLandmarkDetector::getDetectorName() {
 }
 void FaceLandmarkDetector::setDetectorName(std::string detector_name) {
     this->detector_name = detector_name;
-}
\ No newline at end of file
+}
+
+std::vector<LandMarkResult> FaceLandmarkDetector::detect(const cv::Mat & img, std::vector<LandMarkResult> & faces) {
+    ml_cam::FrameContext context(img);
+    return detect(context, faces);
+}
+
+void FaceLandmarkDetector::warmUp() {
+    cv::Mat dummy(300, 300, CV_8UC3, cv::Scalar::all(127));
+    std::vector<LandMarkResult> faces(1);
+    faces[0].setFaceRect(cv::Rect(100, 100, 100, 100));
+    detect(dummy, faces);
+}
+
+std::shared_ptr<FaceLandmarkDetector> FaceLandmarkDetector::clone() {
+    return nullptr;
+}
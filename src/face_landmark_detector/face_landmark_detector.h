@@ -1,9 +1,11 @@
 #ifndef FACE_LANDMARK_DETECTOR_H
 #define FACE_LANDMARK_DETECTOR_H
 
+#include <memory>
 #include <vector>
 #include "opencv2/opencv.hpp"
 #include "landmark_result.h"
+#include "frame_context.h"
 #include "filesystem_include.h"
 
 class FaceLandmarkDetector {
@@ -15,7 +17,19 @@ public:
 
     // This function will receive results from face detection phase
     // then add the results of face alignment phase 
-    virtual std::vector<LandMarkResult> detect(const cv::Mat & img, std::vector<LandMarkResult> & faces) = 0;
+    // Derived images (gray, face crops...) are taken from context,
+    // so they are shared with the face detector
+    virtual std::vector<LandMarkResult> detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces) = 0;
+    std::vector<LandMarkResult> detect(const cv::Mat & img, std::vector<LandMarkResult> & faces);
+
+    // Run one dummy detection. The first inference of some models
+    // (e.g. cv::dnn::Net::forward) is much slower than later ones
+    virtual void warmUp();
+
+    // New instance of the same model, used by another thread.
+    // Read-only model data is shared with this instance where the backend allows it.
+    // Return nullptr if the model cannot be cloned
+    virtual std::shared_ptr<FaceLandmarkDetector> clone();
     std::string getDetectorName();
     void setDetectorName(std::string);
 
@@ -12,11 +12,27 @@ FaceLandmarkDetectorKazemi::FaceLandmarkDetectorKazemi() {
     
 }
 
+// Facemark can only load its model from file, so a clone loads it again
+FaceLandmarkDetectorKazemi::FaceLandmarkDetectorKazemi(const FaceLandmarkDetectorKazemi & other)
+    : FaceLandmarkDetector(other) {
+    fs::path MODEL_PATH_ABS = fs::absolute(MODEL_PATH);
+
+    cv::face::FacemarkKazemi::Params params;
+    facemark = cv::face::FacemarkKazemi::create(params);
+    facemark->loadModel(MODEL_PATH_ABS.string());
+}
+
 FaceLandmarkDetectorKazemi::~FaceLandmarkDetectorKazemi() {
 }
 
+std::shared_ptr<FaceLandmarkDetector> FaceLandmarkDetectorKazemi::clone() {
+    return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorKazemi(*this));
+}
+
+
+std::vector<LandMarkResult> FaceLandmarkDetectorKazemi::detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces) {
 
-std::vector<LandMarkResult> FaceLandmarkDetectorKazemi::detect(const cv::Mat & img, std::vector<LandMarkResult> & faces) {
+    const cv::Mat & img = context.getImage();
 
     if (faces.empty()) {
         return faces;
@@ -39,6 +55,7 @@ std::vector<LandMarkResult> FaceLandmarkDetectorKazemi::detect(const cv::Mat & i
     }
 
     // Detect face landmarks
+    // Kazemi reads pixel intensities from the color image itself, so it needs BGR
     std::vector <std::vector<cv::Point2f>> shapes;
     facemark->fit(img, face_rects, shapes);
 
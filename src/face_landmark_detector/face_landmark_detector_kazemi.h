@@ -13,9 +13,12 @@ private:
 
 public:
     FaceLandmarkDetectorKazemi();
+    FaceLandmarkDetectorKazemi(const FaceLandmarkDetectorKazemi & other);
     ~FaceLandmarkDetectorKazemi();
 
-    std::vector<LandMarkResult> detect(const cv::Mat & img, std::vector<LandMarkResult> & faces);
+    std::shared_ptr<FaceLandmarkDetector> clone();
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces);
 };
 
 
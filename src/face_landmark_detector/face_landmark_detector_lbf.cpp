@@ -12,11 +12,26 @@ FaceLandmarkDetectorLBF::FaceLandmarkDetectorLBF() {
     
 }
 
+// Facemark can only load its model from file, so a clone loads it again
+FaceLandmarkDetectorLBF::FaceLandmarkDetectorLBF(const FaceLandmarkDetectorLBF & other)
+    : FaceLandmarkDetector(other) {
+    fs::path MODEL_PATH_ABS = fs::absolute(MODEL_PATH);
+
+    facemark = cv::face::FacemarkLBF::create();
+    facemark->loadModel(MODEL_PATH_ABS.string());
+}
+
 FaceLandmarkDetectorLBF::~FaceLandmarkDetectorLBF() {
 }
 
+std::shared_ptr<FaceLandmarkDetector> FaceLandmarkDetectorLBF::clone() {
+    return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorLBF(*this));
+}
+
+
+std::vector<LandMarkResult> FaceLandmarkDetectorLBF::detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces) {
 
-std::vector<LandMarkResult> FaceLandmarkDetectorLBF::detect(const cv::Mat & img, std::vector<LandMarkResult> & faces) {
+    const cv::Size img_size = context.getSize();
 
     if (faces.empty()) {
         return faces;
@@ -31,7 +46,7 @@ std::vector<LandMarkResult> FaceLandmarkDetectorLBF::detect(const cv::Mat & img,
 
         // Put face_rect into face_rects to find landmarks only if face_rect lies in the boundary of img.
         // This prevents crashing because of facemark->fit(img, face_rects, shapes);
-        if ( 0 <= face_rect.x && 0 <= face_rect.width && face_rect.x + face_rect.width <= img.cols && 0 <= face_rect.y && 0 <= face_rect.height && face_rect.y + face_rect.height <= img.rows) {
+        if ( 0 <= face_rect.x && 0 <= face_rect.width && face_rect.x + face_rect.width <= img_size.width && 0 <= face_rect.y && 0 <= face_rect.height && face_rect.y + face_rect.height <= img_size.height) {
             face_rects.push_back(face_rect);
             considered_faces_idx.push_back(i);
         }
@@ -39,8 +54,9 @@ std::vector<LandMarkResult> FaceLandmarkDetectorLBF::detect(const cv::Mat & img,
     }
 
     // Detect face landmarks
+    // LBF works on gray image. Give it the shared one so it does not convert again
     std::vector <std::vector<cv::Point2f>> shapes;
-    facemark->fit(img, face_rects, shapes);
+    facemark->fit(context.getGray(), face_rects, shapes);
 
 
     // Merge detected landmarks to landmark results;
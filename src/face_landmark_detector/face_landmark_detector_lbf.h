@@ -13,9 +13,12 @@ private:
 
 public:
     FaceLandmarkDetectorLBF();
+    FaceLandmarkDetectorLBF(const FaceLandmarkDetectorLBF & other);
     ~FaceLandmarkDetectorLBF();
 
-    std::vector<LandMarkResult> detect(const cv::Mat & img, std::vector<LandMarkResult> & faces);
+    std::shared_ptr<FaceLandmarkDetector> clone();
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces);
 };
 
 
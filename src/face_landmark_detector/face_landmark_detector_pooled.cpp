@@ -0,0 +1,34 @@
+#include "face_landmark_detector_pooled.h"
+
+FaceLandmarkDetectorPooled::FaceLandmarkDetectorPooled(std::shared_ptr<ml_cam::ModelPool<FaceLandmarkDetector>> pool)
+    : pool(pool) {
+    ml_cam::ModelPool<FaceLandmarkDetector>::Lease detector = pool->checkout();
+    if (detector) {
+        setDetectorName(detector->getDetectorName());
+    }
+}
+
+FaceLandmarkDetectorPooled::~FaceLandmarkDetectorPooled() {}
+
+std::vector<LandMarkResult> FaceLandmarkDetectorPooled::detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces) {
+    ml_cam::ModelPool<FaceLandmarkDetector>::Lease detector = pool->checkout();
+    if (!detector) {
+        return faces;
+    }
+    return detector->detect(context, faces);
+}
+
+void FaceLandmarkDetectorPooled::warmUp() {
+    ml_cam::ModelPool<FaceLandmarkDetector>::Lease detector = pool->checkout();
+    if (detector) {
+        detector->warmUp();
+    }
+}
+
+std::shared_ptr<FaceLandmarkDetector> FaceLandmarkDetectorPooled::clone() {
+    return std::make_shared<FaceLandmarkDetectorPooled>(pool);
+}
+
+std::shared_ptr<ml_cam::ModelPool<FaceLandmarkDetector>> FaceLandmarkDetectorPooled::getPool() {
+    return pool;
+}
@@ -0,0 +1,26 @@
+#ifndef FACE_LANDMARK_DETECTOR_POOLED_H
+#define FACE_LANDMARK_DETECTOR_POOLED_H
+
+#include <memory>
+#include "face_landmark_detector.h"
+#include "model_pool.h"
+
+// Face landmark detector which can be shared by several threads.
+// Every call checks out an instance from a pool of the same model
+class FaceLandmarkDetectorPooled : public FaceLandmarkDetector {
+private:
+    std::shared_ptr<ml_cam::ModelPool<FaceLandmarkDetector>> pool;
+public:
+    FaceLandmarkDetectorPooled(std::shared_ptr<ml_cam::ModelPool<FaceLandmarkDetector>> pool);
+    ~FaceLandmarkDetectorPooled();
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces);
+    void warmUp();
+
+    // The pooled detector is already thread-safe. Clones share its pool
+    std::shared_ptr<FaceLandmarkDetector> clone();
+
+    std::shared_ptr<ml_cam::ModelPool<FaceLandmarkDetector>> getPool();
+};
+
+#endif
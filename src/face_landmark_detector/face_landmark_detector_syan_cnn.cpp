@@ -12,39 +12,49 @@ FaceLandmarkDetectorSyanCNN::FaceLandmarkDetectorSyanCNN() {
 
 FaceLandmarkDetectorSyanCNN::~FaceLandmarkDetectorSyanCNN() {}
 
+std::shared_ptr<FaceLandmarkDetector> FaceLandmarkDetectorSyanCNN::clone() {
+    return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorSyanCNN(*this));
+}
+
 std::vector<int> FaceLandmarkDetectorSyanCNN::getFacialPoints(const cv::Mat & image) {
-    std::vector<float> flat;
+    return getFacialPoints(std::vector<cv::Mat>(1, image))[0];
+}
 
-    for (int i = 0; i < image.rows; i++){
-        for (int j = 0; j < image.cols; j++){
-            auto x = image.at<uchar>(i, j);
-            flat.push_back(x/255);
-        }
+std::vector<std::vector<int>> FaceLandmarkDetectorSyanCNN::getFacialPoints(const std::vector<cv::Mat> & images) {
+    std::vector<std::vector<int>> facial_points(images.size());
+    if (images.empty()) {
+        return facial_points;
     }
 
-    keras2cpp::Tensor in{96, 96, 1};
-
-    in.data_ = flat;
-
-    // Load model each running time
-    // auto model = keras2cpp::Model::load("./models/alignment_syan_cnn/AN01.model");
-    // keras2cpp::Tensor out = model(in);
-
-    // Use preloaded model from constructor
-    keras2cpp::Tensor out = (*model)(in);
+    // All faces go into one N x 96 x 96 x 1 tensor and through the model in
+    // one batched pass. Pixels are divided by 255 in integer arithmetic, as
+    // the model has always been fed
+    keras2cpp::Tensor in{images.size(), 96, 96, 1};
+    const size_t image_size = 96 * 96;
+    for (size_t i = 0; i < images.size(); i++){
+        const cv::Mat & image = images[i];
+        for (int r = 0; r < image.rows; r++){
+            for (int c = 0; c < image.cols; c++){
+                in.data_[i * image_size + r * image.cols + c] = image.at<uchar>(r, c) / 255;
+            }
+        }
+    }
 
-    std::vector<int> facial_points;
+    // Use preloaded model from constructor. Row i holds the points of face i
+    keras2cpp::Tensor out = model->batch(in);
 
-    for (int i=0; i < 30; i++){
-        std::cout << out(i) << std::endl;
-        int x = 48*out(i) + 48;
-        facial_points.push_back(x);
+    for (size_t i = 0; i < images.size(); i++){
+        for (int j = 0; j < 30; j++){
+            facial_points[i].push_back(static_cast<int>(48*out(i, j) + 48));
+        }
     }
 
     return facial_points;
 }
 
-std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN::detect(const cv::Mat & img, std::vector<LandMarkResult> & faces) {
+std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN::detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces) {
+
+    const cv::Size img_size = context.getSize();
 
     if (faces.empty()) {
         return faces;
@@ -59,7 +69,7 @@ std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN::detect(const cv::Mat &
 
         // Put face_rect into face_rects to find landmarks only if face_rect lies in the boundary of img.
         // This prevents crashing because of facemark->fit(img, face_rects, shapes);
-        if ( 0 <= face_rect.x && 0 <= face_rect.width && face_rect.x + face_rect.width <= img.cols && 0 <= face_rect.y && 0 <= face_rect.height && face_rect.y + face_rect.height <= img.rows) {
+        if ( 0 <= face_rect.x && 0 <= face_rect.width && face_rect.x + face_rect.width <= img_size.width && 0 <= face_rect.y && 0 <= face_rect.height && face_rect.y + face_rect.height <= img_size.height) {
             face_rects.push_back(face_rect);
             considered_faces_idx.push_back(i);
         }
@@ -69,19 +79,20 @@ std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN::detect(const cv::Mat &
     // Detect face landmarks
     std::vector <std::vector<cv::Point2f>> shapes;
 
-    // Fit landmarks
-    for (int i = 0; i < face_rects.size(); ++i) {
+    // Fit landmarks of all faces at once
+    std::vector<cv::Mat> gray_crops;
+    for (size_t i = 0; i < face_rects.size(); ++i) {
+        gray_crops.push_back(context.getGrayCrop(face_rects[i], cv::Size(96, 96))); // The input image must be 96*96
+    }
+    std::vector<std::vector<int>> all_facial_points = getFacialPoints(gray_crops);
 
-        std::vector<cv::Point2f> face_points;
-        cv::Mat crop = img(face_rects[i]);
-        cv::Mat gray_crop;
-        cv::cvtColor(crop, gray_crop, cv::COLOR_BGR2GRAY);
+    for (size_t i = 0; i < face_rects.size(); ++i) {
 
-        float fx = 96.0 / gray_crop.cols;
-        float fy = 96.0 / gray_crop.rows;
-        cv::resize(gray_crop, gray_crop, cv::Size(96, 96)); // The input image must be 96*96
+        std::vector<cv::Point2f> face_points;
 
-        std::vector<int> facial_points = getFacialPoints(gray_crop);
+        float fx = 96.0 / face_rects[i].width;
+        float fy = 96.0 / face_rects[i].height;
+        const std::vector<int> & facial_points = all_facial_points[i];
 
         int num_points = facial_points.size()/2;
         for(int j = 0; j < num_points; j++){
@@ -16,9 +16,15 @@ private:
 public:
     FaceLandmarkDetectorSyanCNN();
     ~FaceLandmarkDetectorSyanCNN();
+
+    // keras2cpp inference only reads the model, so clones share it
+    std::shared_ptr<FaceLandmarkDetector> clone();
     std::vector<int> getFacialPoints(const cv::Mat & image);
 
-    std::vector<LandMarkResult> detect(const cv::Mat & img, std::vector<LandMarkResult> & faces);
+    // Find points of several 96x96 gray faces with a single batched pass
+    std::vector<std::vector<int>> getFacialPoints(const std::vector<cv::Mat> & images);
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces);
 };
 
 
@@ -5,46 +5,69 @@ FaceLandmarkDetectorSyanCNN2::FaceLandmarkDetectorSyanCNN2() {
     setDetectorName("SyanCNN 2");
     fs::path TENSORFLOW_WEIGHT_FILE_PATH_ABS = fs::absolute(TENSORFLOW_WEIGHT_FILE);
     fs::path TENSORFLOW_CONFIG_FILE_PATH_ABS = fs::absolute(TENSORFLOW_CONFIG_FILE);
-    face_model = cv::dnn::readNetFromTensorflow(TENSORFLOW_WEIGHT_FILE_PATH_ABS.string());
+    weight_buffer = ml_cam::readFileBuffer(TENSORFLOW_WEIGHT_FILE_PATH_ABS.string());
+    if (!weight_buffer) {
+        std::cout << "Cannot Open SyanCNN 2 model: " << TENSORFLOW_WEIGHT_FILE_PATH_ABS << std::endl;
+        exit(-1);
+    }
+    face_model = cv::dnn::readNetFromTensorflow(*weight_buffer);
+}
+
+// Every instance needs its own network (cv::dnn::Net is not thread-safe),
+// but it is built from the model file already in memory
+FaceLandmarkDetectorSyanCNN2::FaceLandmarkDetectorSyanCNN2(const FaceLandmarkDetectorSyanCNN2 & other)
+    : FaceLandmarkDetector(other), weight_buffer(other.weight_buffer) {
+    face_model = cv::dnn::readNetFromTensorflow(*weight_buffer);
 }
 
 FaceLandmarkDetectorSyanCNN2::~FaceLandmarkDetectorSyanCNN2() {}
 
+std::shared_ptr<FaceLandmarkDetector> FaceLandmarkDetectorSyanCNN2::clone() {
+    return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorSyanCNN2(*this));
+}
+
 std::vector<int> FaceLandmarkDetectorSyanCNN2::getFacialPoints(const cv::Mat & image) {
-    std::vector<float> flat;
+    return getFacialPoints(std::vector<cv::Mat>(1, image))[0];
+}
+
+std::vector<std::vector<int>> FaceLandmarkDetectorSyanCNN2::getFacialPoints(const std::vector<cv::Mat> & images) {
+    std::vector<std::vector<int>> facial_points(images.size());
+    if (images.empty()) {
+        return facial_points;
+    }
 
-    for (int i = 0; i < image.rows; i++){
-        for (int j = 0; j < image.cols; j++){
-            auto x = image.at<uchar>(i, j);
-            flat.push_back(x/255);
+    // All faces in one N x 9216 input, one row per face, the layout a single
+    // face has always been fed in (a 1 x 9216 row). Pixels are divided by 255
+    // in integer arithmetic, as before
+    int num_images = static_cast<int>(images.size());
+    cv::Mat batch(num_images, 96 * 96, CV_32F);
+    for (int i = 0; i < num_images; i++){
+        const cv::Mat & image = images[i];
+        float * row = batch.ptr<float>(i);
+        for (int r = 0; r < image.rows; r++){
+            for (int c = 0; c < image.cols; c++){
+                row[r * image.cols + c] = image.at<uchar>(r, c) / 255;
+            }
         }
     }
 
-    face_model.setInput(flat);
+    // One forward pass for all faces. Row i holds the points of face i
+    face_model.setInput(batch);
     cv::Mat detection = face_model.forward();
 
-
-    // for (int i = 0; i < detection.rows; i++){
-    //     for (int j = 0; j < detection.cols; j++){
-    //         auto x = detection.at<uchar>(i, j);
-    //         std::cout << detection.at<int>(i, j) << " ";
-    //     }
-    // }
-    // std::cout << std::endl;
-
-    std::vector<int> facial_points;
-
-    for (int i=0; i < detection.cols; i++){
-        auto x = detection.at<float>(0, i);
-        std::cout << x << std::endl;
-        int xx = 48*x + 48;
-        facial_points.push_back(xx);
+    for (int i = 0; i < num_images; i++){
+        for (int j = 0; j < detection.cols; j++){
+            float x = detection.at<float>(i, j);
+            facial_points[i].push_back(static_cast<int>(48*x + 48));
+        }
     }
 
     return facial_points;
 }
 
-std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN2::detect(const cv::Mat & img, std::vector<LandMarkResult> & faces) {
+std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN2::detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces) {
+
+    const cv::Size img_size = context.getSize();
 
     if (faces.empty()) {
         return faces;
@@ -59,7 +82,7 @@ std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN2::detect(const cv::Mat &
 
         // Put face_rect into face_rects to find landmarks only if face_rect lies in the boundary of img.
         // This prevents crashing because of facemark->fit(img, face_rects, shapes);
-        if ( 0 <= face_rect.x && 0 <= face_rect.width && face_rect.x + face_rect.width <= img.cols && 0 <= face_rect.y && 0 <= face_rect.height && face_rect.y + face_rect.height <= img.rows) {
+        if ( 0 <= face_rect.x && 0 <= face_rect.width && face_rect.x + face_rect.width <= img_size.width && 0 <= face_rect.y && 0 <= face_rect.height && face_rect.y + face_rect.height <= img_size.height) {
             face_rects.push_back(face_rect);
             considered_faces_idx.push_back(i);
         }
@@ -69,19 +92,20 @@ std::vector<LandMarkResult> FaceLandmarkDetectorSyanCNN2::detect(const cv::Mat &
     // Detect face landmarks
     std::vector <std::vector<cv::Point2f>> shapes;
 
-    // Fit landmarks
-    for (int i = 0; i < face_rects.size(); ++i) {
+    // Fit landmarks of all faces at once
+    std::vector<cv::Mat> gray_crops;
+    for (size_t i = 0; i < face_rects.size(); ++i) {
+        gray_crops.push_back(context.getGrayCrop(face_rects[i], cv::Size(96, 96))); // The input image must be 96*96
+    }
+    std::vector<std::vector<int>> all_facial_points = getFacialPoints(gray_crops);
+
+    for (size_t i = 0; i < face_rects.size(); ++i) {
 
         std::vector<cv::Point2f> face_points;
-        cv::Mat crop = img(face_rects[i]);
-        cv::Mat gray_crop;
-        cv::cvtColor(crop, gray_crop, cv::COLOR_BGR2GRAY);
-
-        float fx = 96.0 / gray_crop.cols;
-        float fy = 96.0 / gray_crop.rows;
-        cv::resize(gray_crop, gray_crop, cv::Size(96, 96)); // The input image must be 96*96
 
-        std::vector<int> facial_points = getFacialPoints(gray_crop);
+        float fx = 96.0 / face_rects[i].width;
+        float fy = 96.0 / face_rects[i].height;
+        const std::vector<int> & facial_points = all_facial_points[i];
 
         int num_points = facial_points.size()/2;
         for(int j = 0; j < num_points; j++){
@@ -6,6 +6,7 @@
 #include <iostream>
 #include "opencv2/face.hpp"
 #include "keras2cpp/model.h"
+#include "utility.h"
 
 
 class FaceLandmarkDetectorSyanCNN2 : public FaceLandmarkDetector {
@@ -17,12 +18,21 @@ private:
         "./models/alignment_syan_cnn/AN02.pb";
     cv::dnn::Net face_model;
 
+    // Model file is read once and shared by all clones
+    std::shared_ptr<const std::vector<uchar>> weight_buffer;
+
 public:
     FaceLandmarkDetectorSyanCNN2();
+    FaceLandmarkDetectorSyanCNN2(const FaceLandmarkDetectorSyanCNN2 & other);
     ~FaceLandmarkDetectorSyanCNN2();
+
+    std::shared_ptr<FaceLandmarkDetector> clone();
     std::vector<int> getFacialPoints(const cv::Mat & image);
 
-    std::vector<LandMarkResult> detect(const cv::Mat & img, std::vector<LandMarkResult> & faces);
+    // Find points of several 96x96 gray faces with a single forward pass
+    std::vector<std::vector<int>> getFacialPoints(const std::vector<cv::Mat> & images);
+
+    std::vector<LandMarkResult> detect(ml_cam::FrameContext & context, std::vector<LandMarkResult> & faces);
 };
 
 
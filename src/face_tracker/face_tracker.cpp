@@ -0,0 +1,162 @@
+#include "face_tracker.h"
+
+namespace {
+
+float median(std::vector<float> & values) {
+    size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    return values[middle];
+}
+
+}
+
+FaceTracker::FaceTracker() {}
+FaceTracker::~FaceTracker() {}
+
+void FaceTracker::seedPoints(const cv::Mat & gray, const cv::Rect & face_rect, std::vector<cv::Point2f> & points) {
+    points.clear();
+
+    // Only use the inner part of face box. Background near the border
+    // of the box does not move with the face
+    cv::Rect inner(face_rect.x + face_rect.width / 6, face_rect.y + face_rect.height / 6,
+                   face_rect.width * 2 / 3, face_rect.height * 2 / 3);
+    inner &= cv::Rect(0, 0, gray.cols, gray.rows);
+    if (inner.width < 8 || inner.height < 8) {
+        return;
+    }
+
+    std::vector<cv::Point2f> corners;
+    cv::goodFeaturesToTrack(gray(inner), corners, max_points_per_face, 0.01,
+                            std::max(2, inner.width / 10));
+
+    for (size_t i = 0; i < corners.size(); ++i) {
+        points.push_back(corners[i] + cv::Point2f(inner.x, inner.y));
+    }
+}
+
+void FaceTracker::init(ml_cam::FrameContext & context, const std::vector<LandMarkResult> & faces) {
+    prev_gray = context.getGray();
+    this->faces = faces;
+
+    face_points.resize(faces.size());
+    for (size_t i = 0; i < faces.size(); ++i) {
+        seedPoints(prev_gray, faces[i].getFaceRect(), face_points[i]);
+    }
+
+    confidence = 1;
+}
+
+std::vector<LandMarkResult> FaceTracker::track(ml_cam::FrameContext & context) {
+    cv::Mat gray = context.getGray();
+
+    if (prev_gray.empty() || prev_gray.size() != gray.size()) {
+        reset();
+        return faces;
+    }
+
+    // Track points of all faces with one optical flow call
+    std::vector<cv::Point2f> prev_points;
+    for (size_t i = 0; i < face_points.size(); ++i) {
+        prev_points.insert(prev_points.end(), face_points[i].begin(), face_points[i].end());
+    }
+
+    std::vector<cv::Point2f> next_points;
+    std::vector<uchar> status;
+    std::vector<float> err;
+    if (!prev_points.empty()) {
+        cv::calcOpticalFlowPyrLK(prev_gray, gray, prev_points, next_points, status, err,
+                                 cv::Size(15, 15), 2);
+    }
+
+    cv::Rect frame_rect(0, 0, gray.cols, gray.rows);
+    std::vector<LandMarkResult> tracked_faces;
+    std::vector<std::vector<cv::Point2f>> tracked_points;
+    confidence = 1;
+
+    size_t offset = 0;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        size_t num_points = face_points[i].size();
+
+        // Keep points tracked successfully
+        std::vector<cv::Point2f> old_good, new_good;
+        for (size_t j = offset; j < offset + num_points; ++j) {
+            if (status[j] && frame_rect.contains(next_points[j])) {
+                old_good.push_back(prev_points[j]);
+                new_good.push_back(next_points[j]);
+            }
+        }
+        offset += num_points;
+
+        float face_confidence = num_points == 0 ? 0 : static_cast<float>(new_good.size()) / num_points;
+        if (new_good.size() < 3) {
+            face_confidence = 0;
+        }
+        confidence = std::min(confidence, face_confidence);
+
+        // Lost this face
+        if (face_confidence < min_face_confidence) {
+            continue;
+        }
+
+        // Translation: median motion of points
+        std::vector<float> dx, dy;
+        for (size_t j = 0; j < new_good.size(); ++j) {
+            dx.push_back(new_good[j].x - old_good[j].x);
+            dy.push_back(new_good[j].y - old_good[j].y);
+        }
+
+        // Scale: median ratio of distances between consecutive points
+        std::vector<float> ratios;
+        for (size_t j = 1; j < new_good.size(); ++j) {
+            float old_dist = cv::norm(old_good[j] - old_good[j - 1]);
+            float new_dist = cv::norm(new_good[j] - new_good[j - 1]);
+            if (old_dist > 1) {
+                ratios.push_back(new_dist / old_dist);
+            }
+        }
+        float scale = ratios.empty() ? 1 : median(ratios);
+
+        cv::Rect old_rect = faces[i].getFaceRect();
+        cv::Point2f center(old_rect.x + old_rect.width / 2.0f + median(dx),
+                           old_rect.y + old_rect.height / 2.0f + median(dy));
+        float width = old_rect.width * scale;
+        float height = old_rect.height * scale;
+        cv::Rect new_rect(cvRound(center.x - width / 2), cvRound(center.y - height / 2),
+                          cvRound(width), cvRound(height));
+
+        LandMarkResult face = faces[i];
+        face.setFaceRect(new_rect, face.getFaceRectConfidence());
+        tracked_faces.push_back(face);
+
+        // Re-seed points when too many of them were lost
+        if (new_good.size() < static_cast<size_t>(max_points_per_face) / 2) {
+            seedPoints(gray, new_rect, new_good);
+        }
+        tracked_points.push_back(new_good);
+    }
+
+    faces = tracked_faces;
+    face_points = tracked_points;
+    prev_gray = gray;
+
+    return faces;
+}
+
+void FaceTracker::reset() {
+    prev_gray.release();
+    faces.clear();
+    face_points.clear();
+    confidence = 0;
+}
+
+bool FaceTracker::isTracking() {
+    return !prev_gray.empty();
+}
+
+float FaceTracker::getConfidence() {
+    return confidence;
+}
+
+bool FaceTracker::needsRedetection() {
+    return !isTracking() || confidence < redetection_confidence;
+}
@@ -0,0 +1,46 @@
+#ifndef FACE_TRACKER_H
+#define FACE_TRACKER_H
+
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "landmark_result.h"
+#include "frame_context.h"
+
+// Lightweight face tracker used between face detector runs.
+// It tracks a few feature points inside each face box with sparse optical flow
+// (pyramidal Lucas-Kanade) and moves / scales the face box with them.
+// This costs a few small patches per face instead of a full detector pass.
+class FaceTracker {
+private:
+    cv::Mat prev_gray; // Shared with the frame context of previous frame. Never modified
+    std::vector<LandMarkResult> faces;
+    std::vector<std::vector<cv::Point2f>> face_points; // Tracked points of each face
+
+    float confidence = 0; // Tracking confidence of the worst tracked face (0..1)
+
+    int max_points_per_face = 20;
+    float min_face_confidence = 0.3f; // Faces tracked worse than this are dropped
+    float redetection_confidence = 0.6f; // Ask for re-detection under this confidence
+
+    void seedPoints(const cv::Mat & gray, const cv::Rect & face_rect, std::vector<cv::Point2f> & points);
+
+public:
+    FaceTracker();
+    ~FaceTracker();
+
+    // Start tracking faces detected on the frame of context
+    void init(ml_cam::FrameContext & context, const std::vector<LandMarkResult> & faces);
+
+    // Move faces forward to the frame of context. Return tracked faces
+    std::vector<LandMarkResult> track(ml_cam::FrameContext & context);
+
+    void reset();
+    bool isTracking();
+
+    float getConfidence();
+
+    // True when tracking is lost or unreliable and the detector should run again
+    bool needsRedetection();
+};
+
+#endif
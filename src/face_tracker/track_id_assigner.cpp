@@ -0,0 +1,102 @@
+#include "track_id_assigner.h"
+
+TrackIdAssigner::TrackIdAssigner() {}
+TrackIdAssigner::~TrackIdAssigner() {}
+
+cv::Point2f TrackIdAssigner::calcCenter(const cv::Rect & rect) {
+    return cv::Point2f(rect.x + rect.width / 2.0f, rect.y + rect.height / 2.0f);
+}
+
+void TrackIdAssigner::assign(std::vector<LandMarkResult> & faces) {
+
+    // Score every (track, face) pair. Higher is better, negative means no match
+    struct Candidate {
+        float score;
+        size_t track_idx;
+        size_t face_idx;
+    };
+    std::vector<Candidate> candidates;
+    for (size_t t = 0; t < tracks.size(); ++t) {
+
+        // Predict where the track is now
+        cv::Rect predicted = tracks[t].face_rect +
+            cv::Point(cvRound(tracks[t].velocity.x * (tracks[t].missed_frames + 1)),
+                      cvRound(tracks[t].velocity.y * (tracks[t].missed_frames + 1)));
+
+        for (size_t f = 0; f < faces.size(); ++f) {
+            cv::Rect face_rect = faces[f].getFaceRect();
+            float iou = ml_cam::calcIoU(predicted, face_rect);
+            if (iou >= min_iou) {
+                candidates.push_back({1 + iou, t, f});
+                continue;
+            }
+
+            // Fallback for small or fast faces: center distance
+            float distance = cv::norm(calcCenter(predicted) - calcCenter(face_rect));
+            float max_distance = 0.5f * std::max(predicted.width, face_rect.width);
+            if (distance < max_distance) {
+                candidates.push_back({1 - distance / max_distance, t, f});
+            }
+        }
+    }
+
+    // Greedy matching: best pairs first
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate & lhs, const Candidate & rhs) { return lhs.score > rhs.score; });
+
+    std::vector<bool> track_matched(tracks.size(), false);
+    std::vector<bool> face_matched(faces.size(), false);
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const Candidate & c = candidates[i];
+        if (track_matched[c.track_idx] || face_matched[c.face_idx]) {
+            continue;
+        }
+        track_matched[c.track_idx] = true;
+        face_matched[c.face_idx] = true;
+
+        Track & track = tracks[c.track_idx];
+        cv::Rect face_rect = faces[c.face_idx].getFaceRect();
+
+        // Smooth velocity over frames
+        cv::Point2f motion = (calcCenter(face_rect) - calcCenter(track.face_rect)) *
+                             (1.0f / (track.missed_frames + 1));
+        track.velocity = track.age == 0 ? motion : 0.5f * track.velocity + 0.5f * motion;
+        track.face_rect = face_rect;
+        track.missed_frames = 0;
+        ++track.age;
+
+        faces[c.face_idx].setTrack(track.id, track.age, track.velocity);
+    }
+
+    // Forget tracks not seen for a while
+    std::vector<Track> remaining_tracks;
+    for (size_t t = 0; t < tracks.size(); ++t) {
+        if (!track_matched[t]) {
+            ++tracks[t].missed_frames;
+        }
+        if (tracks[t].missed_frames <= max_missed_frames) {
+            remaining_tracks.push_back(tracks[t]);
+        }
+    }
+    tracks = remaining_tracks;
+
+    // New faces start new tracks
+    for (size_t f = 0; f < faces.size(); ++f) {
+        if (face_matched[f]) {
+            continue;
+        }
+        Track track;
+        track.id = next_track_id++;
+        track.age = 0;
+        track.missed_frames = 0;
+        track.face_rect = faces[f].getFaceRect();
+        track.velocity = cv::Point2f(0, 0);
+        tracks.push_back(track);
+
+        faces[f].setTrack(track.id, track.age, track.velocity);
+    }
+}
+
+void TrackIdAssigner::reset() {
+    tracks.clear();
+}
@@ -0,0 +1,41 @@
+#ifndef TRACK_ID_ASSIGNER_H
+#define TRACK_ID_ASSIGNER_H
+
+#include <vector>
+#include "opencv2/opencv.hpp"
+#include "landmark_result.h"
+#include "utility.h"
+
+// Give every face a stable track ID across frames.
+// Faces are matched to the faces of previous frames by overlap (IoU) of
+// face boxes, falling back to distance between face centers.
+// Age and velocity of each track are stored in LandMarkResult too.
+class TrackIdAssigner {
+private:
+    struct Track {
+        int id;
+        int age;
+        int missed_frames; // Number of frames this track has not been seen
+        cv::Rect face_rect;
+        cv::Point2f velocity;
+    };
+
+    std::vector<Track> tracks;
+    int next_track_id = 0;
+
+    float min_iou = 0.3f;
+    int max_missed_frames = 5; // Forget a track after this number of frames without a match
+
+    static cv::Point2f calcCenter(const cv::Rect & rect);
+
+public:
+    TrackIdAssigner();
+    ~TrackIdAssigner();
+
+    // Assign track ID, age and velocity to faces of current frame
+    void assign(std::vector<LandMarkResult> & faces);
+
+    void reset();
+};
+
+#endif
@@ -56,7 +56,7 @@ fs::path FileStorage::getPhotoPath() { return PHOTO_FOLDER; }
 
 fs::path FileStorage::getVideoPath() { return VIDEO_FOLDER; }
 
-bool FileStorage::saveImage(const cv::Mat& img) {
+std::string FileStorage::createUniqueFilename(const std::string & extension) {
 
     // *** Create a unique file name for each image
     // The image path is formated like this: .../FaceCam/Photos/2019-02-08-21-55-88.1549637628399.png
@@ -76,10 +76,22 @@ bool FileStorage::saveImage(const cv::Mat& img) {
     << "-" << std::setw(2) << std::setfill('0') << local_tm.tm_hour
     << "-" << std::setw(2) << std::setfill('0') << local_tm.tm_min 
     << "-" << std::setw(2) << std::setfill('0') << local_tm.tm_sec 
-    << "." << millis << ".png";
+    << "." << millis << extension;
+
+    return filename.str();
+}
+
+fs::path FileStorage::createPhotoPath(const std::string & extension) {
+    return getPhotoPath() / fs::path(createUniqueFilename(extension));
+}
+
+fs::path FileStorage::createVideoPath(const std::string & extension) {
+    return getVideoPath() / fs::path(createUniqueFilename(extension));
+}
 
-    fs::path filepath = getPhotoPath() / fs::path(filename.str());
-    setLastSavedItem(fs::path(filename.str()));
+bool FileStorage::saveImage(const cv::Mat& img) {
+    fs::path filepath = createPhotoPath();
+    setLastSavedItem(filepath.filename());
 
     // *** Save image to file
     cv::imwrite(filepath.string(), img);
@@ -22,6 +22,9 @@ class FileStorage {
 
     fs::path last_saved_item;
 
+    // Unique file name made of current date and time
+    std::string createUniqueFilename(const std::string & extension);
+
    public:
     FileStorage();
     ~FileStorage();
@@ -34,6 +37,12 @@ class FileStorage {
     fs::path getLastSavedItem();
     void setLastSavedItem(fs::path);
 
+    // Create a unique path in the photo folder for a new photo
+    fs::path createPhotoPath(const std::string & extension = ".png");
+
+    // Create a unique path in the video folder for a new video
+    fs::path createVideoPath(const std::string & extension);
+
     bool saveImage(const cv::Mat & img);
 };
 
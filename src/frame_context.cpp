@@ -0,0 +1,167 @@
+#include "frame_context.h"
+
+using namespace ml_cam;
+
+void ml_cam::flipFrame(const cv::Mat & src, cv::Mat & dst, PixelFormat format) {
+    switch (format) {
+        case PixelFormat::YUYV: {
+            // Flip pairs of pixels (Y0 U Y1 V), then swap Y0 and Y1 inside each pair
+            cv::Mat pairs(src.rows, src.cols / 2, CV_8UC4, src.data, src.step);
+            cv::Mat flipped_pairs;
+            cv::flip(pairs, flipped_pairs, 1);
+
+            dst.create(src.size(), src.type());
+            cv::Mat dst_pairs(dst.rows, dst.cols / 2, CV_8UC4, dst.data, dst.step);
+            const int from_to[] = {0, 2, 1, 1, 2, 0, 3, 3};
+            cv::mixChannels(&flipped_pairs, 1, &dst_pairs, 1, from_to, 4);
+            break;
+        }
+        case PixelFormat::NV12: {
+            // Y plane and UV plane (one UV pair for 2x2 pixels) flip separately
+            dst.create(src.size(), src.type());
+            int rows = src.rows * 2 / 3;
+            cv::Mat dst_y = dst.rowRange(0, rows);
+            cv::flip(src.rowRange(0, rows), dst_y, 1);
+
+            cv::Mat src_uv = src.rowRange(rows, src.rows);
+            cv::Mat dst_uv = dst.rowRange(rows, dst.rows);
+            cv::Mat src_uv_pairs(src_uv.rows, src_uv.cols / 2, CV_8UC2, src_uv.data, src_uv.step);
+            cv::Mat dst_uv_pairs(dst_uv.rows, dst_uv.cols / 2, CV_8UC2, dst_uv.data, dst_uv.step);
+            cv::flip(src_uv_pairs, dst_uv_pairs, 1);
+            break;
+        }
+        default:
+            cv::flip(src, dst, 1);
+            break;
+    }
+}
+
+FrameContext::FrameContext(const cv::Mat & image)
+    : raw(image), format(PixelFormat::BGR), width(image.cols), height(image.rows),
+      image(image), has_image(true) {}
+
+FrameContext::FrameContext(const cv::Mat & raw, PixelFormat format, const cv::Mat & image_buffer)
+    : raw(raw), format(format), width(raw.cols),
+      height(format == PixelFormat::NV12 ? raw.rows * 2 / 3 : raw.rows),
+      image(image_buffer), has_image(format == PixelFormat::BGR) {
+    if (format == PixelFormat::BGR) {
+        image = raw;
+    }
+}
+
+const cv::Mat & FrameContext::computeImage() {
+    if (!has_image) {
+        // cvtColor writes into the given buffer when its size and type match
+        if (format == PixelFormat::YUYV) {
+            cv::cvtColor(raw, image, cv::COLOR_YUV2BGR_YUYV);
+        } else {
+            cv::cvtColor(raw, image, cv::COLOR_YUV2BGR_NV12);
+        }
+        has_image = true;
+    }
+    return image;
+}
+
+const cv::Mat & FrameContext::getImage() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return computeImage();
+}
+
+PixelFormat FrameContext::getPixelFormat() const { return format; }
+
+int FrameContext::getWidth() const { return width; }
+
+int FrameContext::getHeight() const { return height; }
+
+cv::Size FrameContext::getSize() const { return cv::Size(width, height); }
+
+const cv::Mat & FrameContext::computeGray() {
+    if (gray.empty()) {
+        if (format == PixelFormat::YUYV) {
+            // Luma is every other byte
+            cv::extractChannel(raw, gray, 0);
+        } else if (format == PixelFormat::NV12) {
+            // Luma plane is the top of the frame
+            gray = raw.rowRange(0, height);
+        } else if (image.channels() == 1) {
+            gray = image;
+        } else {
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+        }
+    }
+    return gray;
+}
+
+cv::Mat FrameContext::getGray() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return computeGray();
+}
+
+cv::Mat FrameContext::getPyramidLevel(int level) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    if (pyramid.empty()) {
+        pyramid.push_back(computeGray());
+    }
+    while (static_cast<int>(pyramid.size()) <= level) {
+        cv::Mat down;
+        cv::pyrDown(pyramid.back(), down);
+        pyramid.push_back(down);
+    }
+
+    return pyramid[std::max(0, level)];
+}
+
+cv::Mat FrameContext::getBlob(const cv::Size & size, double scale, const cv::Scalar & mean,
+                              bool swap_rb) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    for (size_t i = 0; i < blobs.size(); ++i) {
+        if (blobs[i].size == size && blobs[i].scale == scale && blobs[i].mean == mean &&
+            blobs[i].swap_rb == swap_rb) {
+            return blobs[i].blob;
+        }
+    }
+
+    BlobEntry entry;
+    entry.size = size;
+    entry.scale = scale;
+    entry.mean = mean;
+    entry.swap_rb = swap_rb;
+    entry.blob = cv::dnn::blobFromImage(computeImage(), scale, size, mean, swap_rb, false);
+    blobs.push_back(entry);
+
+    return entry.blob;
+}
+
+cv::Mat FrameContext::getGrayCrop(const cv::Rect & rect, const cv::Size & size) {
+    std::lock_guard<std::mutex> guard(mutex);
+
+    for (size_t i = 0; i < gray_crops.size(); ++i) {
+        if (gray_crops[i].rect == rect && gray_crops[i].size == size) {
+            return gray_crops[i].crop;
+        }
+    }
+
+    // Only convert the crop if nobody needed the whole gray frame yet
+    cv::Mat crop;
+    if (!gray.empty() || format == PixelFormat::NV12 || (format == PixelFormat::BGR && image.channels() == 1)) {
+        crop = computeGray()(rect);
+    } else if (format == PixelFormat::YUYV) {
+        cv::extractChannel(raw(rect), crop, 0);
+    } else {
+        cv::cvtColor(image(rect), crop, cv::COLOR_BGR2GRAY);
+    }
+
+    if (!size.empty() && crop.size() != size) {
+        cv::resize(crop, crop, size);
+    }
+
+    CropEntry entry;
+    entry.rect = rect;
+    entry.size = size;
+    entry.crop = crop;
+    gray_crops.push_back(entry);
+
+    return crop;
+}
@@ -0,0 +1,94 @@
+#if !defined(FRAME_CONTEXT_H)
+#define FRAME_CONTEXT_H
+
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace ml_cam {
+
+// Memory layout of a frame
+enum class PixelFormat {
+    BGR,   // rows x cols CV_8UC3 (or CV_8UC1 gray)
+    YUYV,  // Packed 4:2:2 (Y0 U Y1 V), stored as rows x cols CV_8UC2
+    NV12   // Y plane followed by interleaved UV plane, stored as (rows * 3 / 2) x cols CV_8UC1
+};
+
+// Flip a frame horizontally, like cv::flip(src, dst, 1), keeping its pixel format.
+// dst must not be src
+void flipFrame(const cv::Mat & src, cv::Mat & dst, PixelFormat format);
+
+// One frame together with views derived from it (gray image, pyramid,
+// network input blobs, face crops). Every view is computed the first time
+// it is asked for and then shared by all detectors and landmark detectors
+// working on this frame, so it is computed at most once per frame.
+//
+// A frame can also be kept in the native YUV layout of the camera. Gray
+// views then come straight from the Y plane, and the BGR image is only
+// converted when something asks for it.
+//
+// Returned images share data with the cache and must not be modified.
+// The frame itself must not change while the context is in use.
+class FrameContext {
+   private:
+    struct BlobEntry {
+        cv::Size size;
+        double scale;
+        cv::Scalar mean;
+        bool swap_rb;
+        cv::Mat blob;
+    };
+
+    struct CropEntry {
+        cv::Rect rect;
+        cv::Size size;
+        cv::Mat crop;
+    };
+
+    cv::Mat raw;  // Frame in its pixel format
+    PixelFormat format;
+    int width;
+    int height;
+
+    std::mutex mutex;
+    cv::Mat image;  // BGR image. Same as raw for BGR frames
+    bool has_image;
+    cv::Mat gray;
+    std::vector<cv::Mat> pyramid;  // Gray pyramid. Level 0 is the gray image
+    std::vector<BlobEntry> blobs;
+    std::vector<CropEntry> gray_crops;
+
+    const cv::Mat & computeImage();
+    const cv::Mat & computeGray();
+
+   public:
+    explicit FrameContext(const cv::Mat & image);
+
+    // Frame in YUV layout. The BGR image is converted into image_buffer
+    // (if it has the right size and type) when first needed
+    FrameContext(const cv::Mat & raw, PixelFormat format, const cv::Mat & image_buffer = cv::Mat());
+
+    // BGR frame. Converted on first use for YUV frames
+    const cv::Mat & getImage();
+
+    PixelFormat getPixelFormat() const;
+    int getWidth() const;
+    int getHeight() const;
+    cv::Size getSize() const;
+
+    cv::Mat getGray();
+
+    // Gray image downscaled by 2^level
+    cv::Mat getPyramidLevel(int level);
+
+    // Same as cv::dnn::blobFromImage(image, scale, size, mean, swap_rb, false)
+    cv::Mat getBlob(const cv::Size & size, double scale, const cv::Scalar & mean, bool swap_rb);
+
+    // Gray crop of rect resized to size (or not resized if size is empty).
+    // rect must lie inside the frame
+    cv::Mat getGrayCrop(const cv::Rect & rect, const cv::Size & size = cv::Size());
+};
+
+}  // namespace ml_cam
+
+#endif  // FRAME_CONTEXT_H
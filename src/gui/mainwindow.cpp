@@ -1,7 +1,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
-MainWindow::MainWindow(QWidget *parent)
+MainWindow::MainWindow(const ml_cam::CommandLineOptions & options, QWidget *parent)
     : QMainWindow(parent), ui(new Ui::MainWindow) {
     ui->setupUi(this);
     
@@ -12,6 +12,10 @@ MainWindow::MainWindow(QWidget *parent)
     // Connect buttons
     connect(ui->captureBtn, SIGNAL(released()), this,
             SLOT(captureBtn_clicked()));
+    connect(ui->recordBtn, SIGNAL(released()), this,
+            SLOT(recordBtn_clicked()));
+    connect(ui->replayBtn, SIGNAL(released()), this,
+            SLOT(saveReplayVideo()));
     connect(ui->infoBtn, SIGNAL(released()), this, SLOT(showAboutBox()));
     connect(ui->openLibraryBtn, SIGNAL(released()), this,
             SLOT(openLibraryBtn_clicked()));
@@ -25,60 +29,126 @@ MainWindow::MainWindow(QWidget *parent)
             SLOT(faceLandmarkDetectorSelector_activated()));
     connect(ui->effectList, SIGNAL(itemSelectionChanged()), this,
             SLOT(effectList_onselectionchange()));
+    connect(ui->flipCameraCheckBox, SIGNAL(toggled(bool)), this,
+            SLOT(flipCameraCheckBox_toggled(bool)));
 
     // Use space to capture
     QShortcut *shortcut = new QShortcut(QKeySequence(Qt::Key_Space), this);
     QObject::connect(shortcut, SIGNAL(activated()), this, SLOT(captureBtn_clicked()));
 
+    // Use R to start / stop recording
+    QShortcut *record_shortcut = new QShortcut(QKeySequence(Qt::Key_R), this);
+    QObject::connect(record_shortcut, SIGNAL(activated()), this, SLOT(recordBtn_clicked()));
+
+    // Use V / B to save the last seconds as a video / photo burst
+    QShortcut *replay_video_shortcut = new QShortcut(QKeySequence(Qt::Key_V), this);
+    QObject::connect(replay_video_shortcut, SIGNAL(activated()), this, SLOT(saveReplayVideo()));
+    QShortcut *replay_burst_shortcut = new QShortcut(QKeySequence(Qt::Key_B), this);
+    QObject::connect(replay_burst_shortcut, SIGNAL(activated()), this, SLOT(saveReplayBurst()));
+
     // load effects to use in this project
     loadEffects();
 
+    // Settings from command line. Detectors and pipelines are set up with them
+    setPhotoEncoding(options.photo_encoding);
+    setVideoCodec(options.video_codec);
+    setNativeYUV(options.native_yuv);
+    setDetectionSchedule(options.detect_rate > 0 ?
+                             ml_cam::DetectionSchedule::maxRate(options.detect_rate) :
+                             ml_cam::DetectionSchedule::everyNFrames(options.detect_every_frames),
+                         !options.sync_detection);
+    setROIDetection(options.roi_full_scan_interval);
+    setMotionGating(options.motion_threshold);
+    setSSDTiling(options.ssd_tile_size, options.ssd_tile_overlap);
+
     // Load Detectors
+    face_detectors.setMemoryBudget(MODEL_MEMORY_BUDGET);
+    face_landmark_detectors.setMemoryBudget(MODEL_MEMORY_BUDGET);
     loadFaceDetectors();
     loadFaceLandmarkDetectors();
 
+    setupPipeline(pipeline);
+    setFrameSource(options.frame_source);
+
+    // Only the main camera is recorded
+    video_recorder = std::make_shared<ml_cam::VideoRecorder>();
+    pipeline.setVideoRecorder(video_recorder);
+
+    setPreRoll(options.pre_roll_seconds, !options.pre_roll_raw);
+
     refreshCams();
 
     // Init Audio
     SDL_Init(SDL_INIT_AUDIO);
+    shutter_sound.reset(new ml_cam::SoundPlayer("sounds/shutter-fast.wav"));
 }
 
-MainWindow::~MainWindow() { delete ui; }
+MainWindow::~MainWindow() {
+    // Stop pipeline threads and model loading before anything they use is destroyed
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    for (size_t i = 0; i < pipelines.size(); ++i) {
+        pipelines[i]->stop();
+    }
+    QThreadPool::globalInstance()->waitForDone();
+    shutter_sound.reset();
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    delete ui;
+}
 
 void MainWindow::playShutter() {
-    SDL_AudioSpec wavSpec;
-	Uint32 wavLength;
-	Uint8 *wavBuffer;
-
-	SDL_LoadWAV("sounds/shutter-fast.wav", &wavSpec, &wavBuffer, &wavLength);
-	
-	// open audio device
-	SDL_AudioDeviceID deviceId = SDL_OpenAudioDevice(NULL, 0, &wavSpec, NULL, 0);
-
-	// play audio
-	int success = SDL_QueueAudio(deviceId, wavBuffer, wavLength);
-	SDL_PauseAudioDevice(deviceId, 0);
-
-	// keep window open enough to hear the sound
-	SDL_Delay(200);
-
-	// clean up
-	SDL_CloseAudioDevice(deviceId);
-	SDL_FreeWAV(wavBuffer);
+    if (shutter_sound) {
+        shutter_sound->play();
+    }
 }
 
 void MainWindow::captureBtn_clicked() {
-    fs.saveImage(getCurrentImage());
+    std::shared_ptr<const cv::Mat> snapshot = getCurrentImage();
+    if (!snapshot || snapshot->empty()) {
+        return;
+    }
 
-    // *** Update icon of library to current image
-    cv::Mat current_img = getCurrentImage();
+    // Encode and write the photo in background. Library is updated
+    // in onPhotoSaved() when the file is written
+    fs::path photo_path = fs.createPhotoPath(photo_writer.getEncoding().getExtension());
+    bool queued = photo_writer.write(snapshot, photo_path,
+        [this, snapshot](const fs::path & path, bool success) {
+            if (!success) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> guard(saved_photos_mutex);
+                saved_photos.push_back(SavedPhoto{path, snapshot});
+            }
+            QMetaObject::invokeMethod(this, "onPhotoSaved", Qt::QueuedConnection);
+        });
+    if (!queued) {
+        std::cerr << "Too many photos waiting to be written. Photo is skipped." << std::endl;
+        return;
+    }
 
     // Play sound file
     playShutter();
+}
 
+void MainWindow::onPhotoSaved() {
+    std::vector<SavedPhoto> photos;
+    {
+        std::lock_guard<std::mutex> guard(saved_photos_mutex);
+        photos.swap(saved_photos);
+    }
+    if (photos.empty()) {
+        return;
+    }
+
+    // Only the latest photo is shown in library
+    fs.setLastSavedItem(photos.back().path.filename());
+    updateLibraryIcon(*photos.back().image);
+}
+
+void MainWindow::updateLibraryIcon(const cv::Mat & photo) {
     // Create icon by cropping
-    int width = current_img.cols;
-    int height = current_img.rows;
+    int width = photo.cols;
+    int height = photo.rows;
     int padding_x = 0, padding_y = 0;
     int crop_size;
     if (width <= height) {
@@ -89,9 +159,11 @@ void MainWindow::captureBtn_clicked() {
         padding_x = (width - height) / 2;
     }
 
-    cv::Mat crop =
-        current_img(cv::Rect(padding_x, padding_y, crop_size, crop_size));
-    cv::cvtColor(crop, crop, cv::COLOR_BGR2RGB);
+    // Convert into a new buffer: the snapshot is shared and must not change
+    cv::Mat crop;
+    cv::cvtColor(
+        photo(cv::Rect(padding_x, padding_y, crop_size, crop_size)),
+        crop, cv::COLOR_BGR2RGB);
 
     cv::Mat white_bg(50, 50, CV_8UC3, cv::Scalar(255, 255, 255));
 
@@ -104,6 +176,115 @@ void MainWindow::captureBtn_clicked() {
     ui->openLibraryBtn->setIcon(QIcon(QPixmap::fromImage(btn_icon)));
 }
 
+void MainWindow::setPhotoEncoding(const ml_cam::PhotoEncoding & encoding) {
+    photo_writer.setEncoding(encoding);
+}
+
+void MainWindow::setVideoCodec(const std::string & codec) {
+    video_codec = codec;
+}
+
+void MainWindow::setNativeYUV(bool native_yuv) {
+    this->native_yuv = native_yuv;
+}
+
+void MainWindow::setDetectionSchedule(const ml_cam::DetectionSchedule & schedule, bool async_detection) {
+    detection_schedule = schedule;
+    this->async_detection = async_detection;
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    for (size_t i = 0; i < pipelines.size(); ++i) {
+        pipelines[i]->setAsyncDetection(async_detection);
+        pipelines[i]->setDetectionSchedule(detection_schedule);
+    }
+}
+
+void MainWindow::setROIDetection(int full_scan_interval) {
+    roi_full_scan_interval = full_scan_interval;
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    for (size_t i = 0; i < pipelines.size(); ++i) {
+        pipelines[i]->setROIDetection(roi_full_scan_interval > 0,
+                                      ml_cam::DetectionSchedule::everyNFrames(roi_full_scan_interval));
+    }
+}
+
+void MainWindow::setMotionGating(float threshold) {
+    motion_threshold = threshold;
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    for (size_t i = 0; i < pipelines.size(); ++i) {
+        pipelines[i]->setMotionGating(motion_threshold > 0, motion_threshold);
+    }
+}
+
+void MainWindow::setSSDTiling(int tile_size, float tile_overlap) {
+    ssd_tile_size = tile_size;
+    ssd_tile_overlap = tile_overlap;
+}
+
+void MainWindow::recordBtn_clicked() {
+    if (video_recorder->isRecording()) {
+        video_recorder->stop();
+        std::cout << "Recorded " << video_recorder->getWrittenFrameCount() << " frames to "
+                  << video_recorder->getPath() << ", dropped "
+                  << video_recorder->getDroppedFrameCount() << " frames" << std::endl;
+    } else {
+        // Video plays at the rate frames are rendered
+        fs::path path = fs.createVideoPath(ml_cam::VideoRecorder::getFileExtension(video_codec));
+        video_recorder->start(path, video_codec, getPipelineFrameRate());
+    }
+    updateRecordButton();
+}
+
+void MainWindow::setPreRoll(double seconds, bool compress) {
+    if (seconds > 0) {
+        pre_roll.reset(new ml_cam::PreRollBuffer(seconds, 30, compress));
+    } else {
+        pre_roll.reset();
+    }
+    ui->replayBtn->setEnabled(pre_roll != nullptr);
+}
+
+void MainWindow::saveReplayVideo() {
+    if (!pre_roll) {
+        return;
+    }
+
+    // Frames are copied out of the ring, then written in background
+    std::vector<ml_cam::PreRollBuffer::Frame> frames = pre_roll->getFrames();
+    fs::path path = fs.createVideoPath(ml_cam::VideoRecorder::getFileExtension(video_codec));
+    int fourcc = ml_cam::VideoRecorder::parseCodec(video_codec);
+    QtConcurrent::run([frames, path, fourcc] {
+        if (ml_cam::PreRollBuffer::writeVideo(frames, path, fourcc)) {
+            std::cout << "Saved replay of " << frames.size() << " frames to " << path << std::endl;
+        }
+    });
+}
+
+void MainWindow::saveReplayBurst() {
+    if (!pre_roll) {
+        return;
+    }
+
+    std::vector<ml_cam::PreRollBuffer::Frame> frames = pre_roll->getFrames();
+    fs::path directory = fs.createPhotoPath("");
+    QtConcurrent::run([frames, directory] {
+        if (ml_cam::PreRollBuffer::writeBurst(frames, directory)) {
+            std::cout << "Saved burst of " << frames.size() << " photos to " << directory << std::endl;
+        }
+    });
+}
+
+void MainWindow::updateRecordButton() {
+    bool recording = video_recorder->isRecording();
+    if (recording) {
+        ui->recordBtn->setText(QString("Stop (%1 queued, %2 dropped)")
+            .arg(video_recorder->getQueueDepth())
+            .arg(video_recorder->getDroppedFrameCount()));
+    } else if (record_button_recording) {
+        ui->recordBtn->setText("Record (R)");
+    }
+    record_button_recording = recording;
+}
+
 void MainWindow::openLibraryBtn_clicked() {
     std::string command;
 
@@ -116,11 +297,89 @@ void MainWindow::openLibraryBtn_clicked() {
     std::system(command.c_str());
 }
 
+// Load a model on the thread pool and warm it up, then call on_ready on GUI thread.
+// While loading, the model is marked as "loading" in its selector
+template <typename T>
+void MainWindow::loadModelAsync(ml_cam::ModelRegistry<T> & registry, int index, QComboBox * selector,
+                                std::function<void(std::shared_ptr<T>)> on_ready) {
+
+    // Already loading. Its finished handler uses it if it is still selected
+    std::string name = registry.getInfo(index).name;
+    if (loading_models.count(name)) {
+        return;
+    }
+
+    if (registry.isLoaded(index)) {
+        on_ready(registry.get(index));
+        return;
+    }
+
+    loading_models.insert(name);
+    selector->setItemText(selector->findData(index),
+                          QString::fromUtf8((name + " (loading...)").c_str()));
+
+    QFutureWatcher<std::shared_ptr<T>> *watcher = new QFutureWatcher<std::shared_ptr<T>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [=] {
+        loading_models.erase(name);
+        selector->setItemText(selector->findData(index), QString::fromUtf8(name.c_str()));
+        on_ready(watcher->result());
+        watcher->deleteLater();
+    });
+
+    ml_cam::ModelRegistry<T> *registry_ptr = &registry;
+    watcher->setFuture(QtConcurrent::run([registry_ptr, index] {
+        std::shared_ptr<T> model = registry_ptr->get(index);
+        model->warmUp();
+        return model;
+    }));
+}
+
+template <typename T>
+std::shared_ptr<ml_cam::ModelPool<T>> MainWindow::getModelPool(std::map<int, PooledModel<T>> & pools, int index,
+                                                               std::shared_ptr<T> instance) {
+    PooledModel<T> & pooled = pools[index];
+    std::shared_ptr<ml_cam::ModelPool<T>> pool = pooled.pool.lock();
+    if (pool && pooled.prototype.lock() == instance) {
+        return pool;
+    }
+
+    pool = std::make_shared<ml_cam::ModelPool<T>>(instance, [instance] { return instance->clone(); });
+    pooled.prototype = instance;
+    pooled.pool = pool;
+    return pool;
+}
+
 void MainWindow::faceDetectorSelector_activated() {
     current_face_detector_index =
         ui->faceDetectorSelector
             ->itemData(ui->faceDetectorSelector->currentIndex())
             .toInt();
+
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    if (current_face_detector_index < 0) {
+        face_detector = nullptr;
+        for (size_t i = 0; i < pipelines.size(); ++i) {
+            pipelines[i]->setFaceDetector(nullptr);
+        }
+        return;
+    }
+
+    // Model is loaded the first time it is selected.
+    // Pipelines keep using the previous model until the new one is ready.
+    // More instances are only created when pipelines need it at the same time
+    int index = current_face_detector_index;
+    loadModelAsync<FaceDetector>(face_detectors, index, ui->faceDetectorSelector,
+        [this, index](std::shared_ptr<FaceDetector> detector) {
+            if (current_face_detector_index != index) {
+                return;
+            }
+            face_detector = std::make_shared<FaceDetectorPooled>(
+                getModelPool<FaceDetector>(face_detector_pools, index, detector));
+            std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+            for (size_t i = 0; i < pipelines.size(); ++i) {
+                pipelines[i]->setFaceDetector(face_detector);
+            }
+        });
 }
 
 void MainWindow::faceLandmarkDetectorSelector_activated() {
@@ -128,6 +387,31 @@ void MainWindow::faceLandmarkDetectorSelector_activated() {
         ui->faceLandmarkDetectorSelector
             ->itemData(ui->faceLandmarkDetectorSelector->currentIndex())
             .toInt();
+
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    if (current_face_landmark_detector_index < 0) {
+        face_landmark_detector = nullptr;
+        for (size_t i = 0; i < pipelines.size(); ++i) {
+            pipelines[i]->setFaceLandmarkDetector(nullptr);
+        }
+        return;
+    }
+
+    // Model is loaded the first time it is selected.
+    // Pipelines keep using the previous model until the new one is ready
+    int index = current_face_landmark_detector_index;
+    loadModelAsync<FaceLandmarkDetector>(face_landmark_detectors, index, ui->faceLandmarkDetectorSelector,
+        [this, index](std::shared_ptr<FaceLandmarkDetector> detector) {
+            if (current_face_landmark_detector_index != index) {
+                return;
+            }
+            face_landmark_detector = std::make_shared<FaceLandmarkDetectorPooled>(
+                getModelPool<FaceLandmarkDetector>(face_landmark_detector_pools, index, detector));
+            std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+            for (size_t i = 0; i < pipelines.size(); ++i) {
+                pipelines[i]->setFaceLandmarkDetector(face_landmark_detector);
+            }
+        });
 }
 
 void MainWindow::cameraSelector_activated() {
@@ -135,6 +419,18 @@ void MainWindow::cameraSelector_activated() {
         ui->cameraSelector
             ->itemData(ui->cameraSelector->currentIndex())
             .toInt();
+
+    // User changed camera. Camera list is refreshed in background
+    if (selected_camera_index != current_camera_index || frame_source) {
+        pipeline.stop();
+        current_camera_index = selected_camera_index;
+        frame_source = nullptr;
+        if (!startPipeline()) {
+            onCameraLost();
+            return;
+        }
+        refreshCams();
+    }
 }
 
 void MainWindow::effectList_onselectionchange() {
@@ -143,8 +439,32 @@ void MainWindow::effectList_onselectionchange() {
     // Save selected effects
     selected_effect_indices.clear();
     for (int i = 0; i < selected_effects.count(); ++i) {
-        selected_effect_indices.push_back(
-            selected_effects[i]->data(Qt::UserRole).toInt());
+        int effect_index = selected_effects[i]->data(Qt::UserRole).toInt();
+        selected_effect_indices.push_back(effect_index);
+    }
+
+    pipeline.setImageEffects(getSelectedEffects(image_effects));
+    for (size_t i = 0; i < extra_cameras.size(); ++i) {
+        extra_cameras[i]->pipeline->setImageEffects(getSelectedEffects(extra_cameras[i]->image_effects));
+    }
+}
+
+// Pick selected effects from the effects of one camera
+std::vector<std::shared_ptr<ImageEffect>> MainWindow::getSelectedEffects(
+    const std::vector<std::shared_ptr<ImageEffect>> & effects) {
+    std::vector<std::shared_ptr<ImageEffect>> selected;
+    for (size_t i = 0; i < selected_effect_indices.size(); ++i) {
+        if (selected_effect_indices[i] >= 0) {
+            selected.push_back(effects[selected_effect_indices[i]]);
+        }
+    }
+    return selected;
+}
+
+void MainWindow::flipCameraCheckBox_toggled(bool checked) {
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    for (size_t i = 0; i < pipelines.size(); ++i) {
+        pipelines[i]->setFlip(checked);
     }
 }
 
@@ -163,209 +483,375 @@ void MainWindow::showAboutBox() {
 }
 
 void MainWindow::showCam() {
-    using namespace cv;
 
-    if (!video.open(current_camera_index)) {
+    pipeline.setCameraLostCallback([this] {
+        QMetaObject::invokeMethod(this, "onCameraLost", Qt::QueuedConnection);
+    });
+
+    if (!startPipeline()) {
+        if (frame_source) {
+            QMessageBox::critical(this, "Frame Source Error",
+                                  "Cannot open the selected frame source!");
+            return;
+        }
         QMessageBox::critical(
             this, "Camera Error",
             "Make sure you entered a correct camera index,"
             "<br>or that the camera is not being accessed by another program!");
         return;
     }
+}
+
+// Settings shared by the pipelines of all cameras
+void MainWindow::setupPipeline(ml_cam::ProcessingPipeline & target) {
+    target.setFlip(ui->flipCameraCheckBox->isChecked());
+
+    // Render every frame and detect faces in background (by default).
+    // Frames in between are tracked with optical flow; the detector
+    // re-acquires faces when the schedule is due or tracking gets unreliable
+    target.setAsyncDetection(async_detection);
+    target.setFaceTracking(true);
+    target.setDetectionSchedule(detection_schedule);
+    target.setROIDetection(roi_full_scan_interval > 0,
+                           ml_cam::DetectionSchedule::everyNFrames(roi_full_scan_interval));
+    target.setMotionGating(motion_threshold > 0, motion_threshold);
+
+    target.setFaceDetector(face_detector);
+    target.setFaceLandmarkDetector(face_landmark_detector);
+
+    // Wake up GUI thread when a pipeline has a finished frame.
+    // Only one wake-up is queued at a time, the slot displays the newest frames
+    target.setFrameReadyCallback([this] {
+        if (!frame_ready_pending.exchange(true)) {
+            QMetaObject::invokeMethod(this, "onFrameReady", Qt::QueuedConnection);
+        }
+    });
+}
+
+std::vector<ml_cam::ProcessingPipeline *> MainWindow::getPipelines() {
+    std::vector<ml_cam::ProcessingPipeline *> pipelines;
+    pipelines.push_back(&pipeline);
+    for (size_t i = 0; i < extra_cameras.size(); ++i) {
+        pipelines.push_back(extra_cameras[i]->pipeline.get());
+    }
+    return pipelines;
+}
+
+void MainWindow::addCamera(int camera_index) {
+    std::unique_ptr<CameraView> view(new CameraView());
+    view->camera_index = camera_index;
+    view->pipeline.reset(new ml_cam::ProcessingPipeline());
+    view->image_effects = createEffects();
+
+    setupPipeline(*view->pipeline);
+    view->pipeline->setImageEffects(getSelectedEffects(view->image_effects));
+    view->pipeline->setCameraLostCallback([this] {
+        QMetaObject::invokeMethod(this, "removeLostCameras", Qt::QueuedConnection);
+    });
+
+    if (!view->pipeline->start(camera_index, native_yuv)) {
+        QMessageBox::warning(this, "Camera Error",
+                             QString("Cannot open camera %1!").arg(camera_index));
+        return;
+    }
+
+    ui->graphicsView->scene()->addItem(&view->pixmap);
+    extra_cameras.push_back(std::move(view));
+    layoutPreviews();
+}
+
+void MainWindow::removeLostCameras() {
+    for (size_t i = 0; i < extra_cameras.size();) {
+        if (extra_cameras[i]->pipeline->isSourceOpened()) {
+            ++i;
+            continue;
+        }
+        extra_cameras[i]->pipeline->stop();
+        ui->graphicsView->scene()->removeItem(&extra_cameras[i]->pixmap);
+        extra_cameras.erase(extra_cameras.begin() + i);
+    }
+    layoutPreviews();
+}
+
+void MainWindow::setFrameSource(std::shared_ptr<ml_cam::FrameSource> source) {
+    frame_source = source;
+
+    // Measure throughput: no stage may drop frames
+    if (frame_source && frame_source->isFreeRun()) {
+        pipeline.setDropPolicy(ml_cam::DropPolicy::Block);
+    }
+}
+
+bool MainWindow::startPipeline() {
+    pipeline_start_time = Timer::getCurrentTime();
+    if (frame_source) {
+        return pipeline.start(frame_source);
+    }
+    return pipeline.start(current_camera_index, native_yuv);
+}
+
+double MainWindow::getPipelineFrameRate() {
+    Timer::time_duration_t duration = Timer::calcTimePassed(pipeline_start_time);
+    uint64_t frames = pipeline.getRenderedFrameCount();
+    return duration > 0 ? 1000.0 * frames / duration : 0;
+}
+
+void MainWindow::printPipelineStats() {
+    Timer::time_duration_t duration = Timer::calcTimePassed(pipeline_start_time);
+    uint64_t frames = pipeline.getRenderedFrameCount();
+    double fps = getPipelineFrameRate();
+    std::cout << "Processed " << frames << " frames in " << duration << " ms ("
+              << fps << " FPS), dropped " << pipeline.getDroppedFrameCount()
+              << " frames" << std::endl;
+    if (motion_threshold > 0) {
+        std::cout << "Motion gating skipped " << pipeline.getDetectionSkipRatio() * 100
+                  << "% of detections, " << pipeline.getPartialDetectionRatio() * 100
+                  << "% ran on changed regions only" << std::endl;
+    }
+}
 
-    Mat frame;
-    while (true) {
+void MainWindow::onFrameReady() {
+    frame_ready_pending = false;
 
-        // User changed camera
-        if (selected_camera_index != current_camera_index) {
-            
-            video.release();
-            refreshCams();
-            current_camera_index = selected_camera_index;
-            video.open(current_camera_index);
+    ml_cam::FramePacketPtr packet;
+    for (size_t i = 0; i < extra_cameras.size(); ++i) {
+        if (extra_cameras[i]->pipeline->takeLatestFinishedFrame(packet)) {
+            setPixmapFrame(extra_cameras[i]->pixmap, packet->frame);
+        }
+    }
 
-        } else if (!video.isOpened()) {
+    if (pipeline.takeLatestFinishedFrame(packet)) {
+        displayFrame(packet->frame);
+        updateRecordButton();
+    } else if (!extra_cameras.empty()) {
+        layoutPreviews();
+    }
+}
 
-            // Reset to default camera (0)
-            refreshCams();
-            current_camera_index = selected_camera_index =
-            ui->cameraSelector
-                ->itemData(ui->cameraSelector->currentIndex())
-                .toInt();
-            ui->cameraSelector->setCurrentIndex(0);
-            video.open(current_camera_index);
+void MainWindow::onCameraLost() {
 
+    // Frame source ran out of frames. A free-running source is used
+    // to measure throughput, so the program is done
+    if (frame_source) {
+        // Report after the stages finished the queued frames
+        pipeline.stop();
+        printPipelineStats();
+        if (frame_source->isFreeRun()) {
+            QApplication::quit();
         }
+        return;
+    }
+
+    // Reset to default camera (the first one found)
+    // once the camera list is refreshed
+    pipeline.stop();
+    camera_enumerator.invalidate();
+    refreshCamsAsync([this] {
+        ui->cameraSelector->setCurrentIndex(0);
+        current_camera_index = selected_camera_index =
+        ui->cameraSelector
+            ->itemData(ui->cameraSelector->currentIndex())
+            .toInt();
 
         // If we still cannot open camera, exit the program
-        if (!video.isOpened()) {
+        if (!startPipeline()) {
             QMessageBox::critical(
             this, "Camera Error",
             "Make sure you entered a correct camera index,"
             "<br>or that the camera is not being accessed by another program!");
-            exit(1);
+            QApplication::exit(1);
         }
+    });
+}
 
-        video >> frame;
-        if (!frame.empty()) {
-
-            // Flip frame
-            if (ui->flipCameraCheckBox->isChecked()) {
-                flip(frame, frame, 1);
-            }
-
-            // Detect Faces
-            Timer::time_duration_t face_detection_duration;
-            Timer::time_duration_t face_alignment_duration;
-            std::vector<LandMarkResult> faces;
-            if (current_face_detector_index >= 0) {
-
-                Timer::time_point_t start_time = Timer::getCurrentTime();
-                faces = face_detectors[current_face_detector_index]->detect(frame);
-                face_detection_duration = Timer::calcTimePassed(start_time);
-
-                if (current_face_landmark_detector_index >= 0) {
-                    start_time = Timer::getCurrentTime();
-                    face_landmark_detectors[current_face_landmark_detector_index]->detect(frame, faces);
-                    face_alignment_duration = Timer::calcTimePassed(start_time);
-                }
-            } else {  // Clear old results
-                face_detection_duration = 0;
-                face_alignment_duration = 0;
-                faces.clear();
-            }
-
-            // Sort faces ascending by size  => Draw face filters for smaller faces behind those for bigger faces
-            std::sort(std::begin(faces), std::end(faces),
-                    [] (const auto& lhs, const auto& rhs) {
-                return lhs.getFaceRect().area() < rhs.getFaceRect().area();
-            });
+void MainWindow::displayFrame(const cv::Mat & frame) {
+    setCurrentImage(frame);
+    if (pre_roll) {
+        pre_roll->addFrame(frame);
+    }
 
+    // ### Show current image
+    setPixmapFrame(pixmap, frame);
+    layoutPreviews();
+}
 
-            // Apply effects / filters
-            for (size_t i = 0; i < selected_effect_indices.size(); ++i) {
-                if (selected_effect_indices[i] >= 0) {
+void MainWindow::setPixmapFrame(QGraphicsPixmapItem & item, const cv::Mat & frame) {
 
-                    // Output FPS in debug
-                    if (image_effects[selected_effect_indices[i]]->getName() == "Debug Info") {
+    // Convert to RGB into a recycled buffer. QPixmap makes its own copy
+    cv::Mat rgb = display_buffer_pool.acquire(frame.size(), CV_8UC3);
+    cv::cvtColor(frame, rgb, cv::COLOR_BGR2RGB);
 
-                        float detection_fps = face_detection_duration == 0 ? 0 : 1000.0 / face_detection_duration;
-                        float alignment_fps = face_alignment_duration == 0 ? 0 : 1000.0 / face_alignment_duration;
+    QImage qimg(rgb.data, static_cast<int>(rgb.cols),
+                static_cast<int>(rgb.rows),
+                static_cast<int>(rgb.step), QImage::Format_RGB888);
+    item.setPixmap(QPixmap::fromImage(qimg));
+}
 
-                        std::dynamic_pointer_cast<EffectDebugInfo>(image_effects[selected_effect_indices[i]])->outputFPS(detection_fps, alignment_fps);
-                    }
+// Tile previews of all cameras in a grid. Every tile has the size
+// of the main preview, other previews are scaled to fit into it
+void MainWindow::layoutPreviews() {
+    if (extra_cameras.empty()) {
+        pixmap.setPos(0, 0);
+        pixmap.setScale(1);
+        ui->graphicsView->fitInView(&pixmap, Qt::KeepAspectRatio);
+        return;
+    }
 
-                    image_effects[selected_effect_indices[i]]->apply(frame, faces);
-                }
-            }
+    std::vector<QGraphicsPixmapItem *> items;
+    items.push_back(&pixmap);
+    for (size_t i = 0; i < extra_cameras.size(); ++i) {
+        items.push_back(&extra_cameras[i]->pixmap);
+    }
 
-            setCurrentImage(frame);
+    QSizeF tile_size = pixmap.pixmap().isNull() ? QSizeF(640, 480) : QSizeF(pixmap.pixmap().size());
+    int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(items.size()))));
+    int rows = static_cast<int>((items.size() + cols - 1) / cols);
 
-            // ### Show current image
-            QImage qimg(frame.data, static_cast<int>(frame.cols),
-                        static_cast<int>(frame.rows),
-                        static_cast<int>(frame.step), QImage::Format_RGB888);
-            pixmap.setPixmap(QPixmap::fromImage(qimg.rgbSwapped()));
-            ui->graphicsView->fitInView(&pixmap, Qt::KeepAspectRatio);
+    for (size_t i = 0; i < items.size(); ++i) {
+        QSizeF size = items[i]->pixmap().size();
+        qreal scale = 1;
+        if (!size.isEmpty()) {
+            scale = std::min(tile_size.width() / size.width(), tile_size.height() / size.height());
         }
-        qApp->processEvents();
+        items[i]->setScale(scale);
+        items[i]->setPos((i % cols) * tile_size.width(), (i / cols) * tile_size.height());
     }
+
+    ui->graphicsView->fitInView(QRectF(0, 0, cols * tile_size.width(), rows * tile_size.height()),
+                                Qt::KeepAspectRatio);
 }
 
 void MainWindow::closeEvent(QCloseEvent *event) {
-    if (video.isOpened()) {
-        video.release();
+    std::vector<ml_cam::ProcessingPipeline *> pipelines = getPipelines();
+    for (size_t i = 0; i < pipelines.size(); ++i) {
+        pipelines[i]->stop();
     }
+    event->accept();
     QApplication::quit();
-    exit(0);
 }
 
-// Load face detectors
+// Register face detectors. Models are only loaded when they are selected
 void MainWindow::loadFaceDetectors() {
     
     // SSD - ResNet10 detector
-    face_detectors.push_back(
-        std::shared_ptr<FaceDetector>(new FaceDetectorSSDResNet10()));
+    face_detectors.add({"SSD ResNet10",
+        {"models/detect_ssd_resnet10/opencv_face_detector_uint8.pb",
+         "models/detect_ssd_resnet10/opencv_face_detector.pbtxt"}},
+        [] { return std::shared_ptr<FaceDetector>(new FaceDetectorSSDResNet10()); });
+
+    // SSD - ResNet10 detector on overlapping tiles, for small faces in large frames.
+    // Tiles run on one network per worker thread
+    face_detectors.add({"SSD ResNet10 - Tiled",
+        {"models/detect_ssd_resnet10/opencv_face_detector_uint8.pb",
+         "models/detect_ssd_resnet10/opencv_face_detector.pbtxt"},
+        FaceDetectorSSDResNet10::getNetworkCount(ssd_tile_size, ssd_tile_overlap)},
+        [this] {
+            std::shared_ptr<FaceDetectorSSDResNet10> detector = std::make_shared<FaceDetectorSSDResNet10>();
+            detector->setDetectorName("SSD ResNet10 - Tiled");
+            detector->setTiling(ssd_tile_size, ssd_tile_overlap);
+            return std::shared_ptr<FaceDetector>(detector);
+        });
 
     // Haar cascade detector
-    face_detectors.push_back(
-        std::shared_ptr<FaceDetector>(new FaceDetectorCascade("HaarCascade - OpenCV model", "models/detect_haarcascade/haarcascade_frontalface.xml")));
+    face_detectors.add({"HaarCascade - OpenCV model", {"models/detect_haarcascade/haarcascade_frontalface.xml"}},
+        [] { return std::shared_ptr<FaceDetector>(new FaceDetectorCascade("HaarCascade - OpenCV model", "models/detect_haarcascade/haarcascade_frontalface.xml")); });
 
     // Haar cascade detector v1
-    face_detectors.push_back(
-        std::shared_ptr<FaceDetector>(new FaceDetectorCascade("HaarCascade - T02_27", "models/detect_haarcascade/T02_27.xml")));
+    face_detectors.add({"HaarCascade - T02_27", {"models/detect_haarcascade/T02_27.xml"}},
+        [] { return std::shared_ptr<FaceDetector>(new FaceDetectorCascade("HaarCascade - T02_27", "models/detect_haarcascade/T02_27.xml")); });
 
     // LBF cascade detector
     // Pretrained model v6 - vietanhdev
-    face_detectors.push_back(
-        std::shared_ptr<FaceDetector>(new FaceDetectorCascade("LBFCascade - vietanhdev", "models/detect_lbfcascade/lbf_fact_detect_6.xml")));
+    face_detectors.add({"LBFCascade - vietanhdev", {"models/detect_lbfcascade/lbf_fact_detect_6.xml"}},
+        [] { return std::shared_ptr<FaceDetector>(new FaceDetectorCascade("LBFCascade - vietanhdev", "models/detect_lbfcascade/lbf_fact_detect_6.xml")); });
+
+    // Two-stage detector: LBF cascade proposes faces, SSD ResNet10 verifies them on crops
+    face_detectors.add({"Two-Stage - LBFCascade + SSD ResNet10",
+        {"models/detect_lbfcascade/lbf_fact_detect_6.xml",
+         "models/detect_ssd_resnet10/opencv_face_detector_uint8.pb",
+         "models/detect_ssd_resnet10/opencv_face_detector.pbtxt"}},
+        [] { return std::shared_ptr<FaceDetector>(new FaceDetectorTwoStage("Two-Stage - LBFCascade + SSD ResNet10",
+                 std::make_shared<FaceDetectorCascade>("LBFCascade - vietanhdev", "models/detect_lbfcascade/lbf_fact_detect_6.xml"),
+                 std::make_shared<FaceDetectorSSDResNet10>())); });
 
     // Add detectors to selector box of GUI
     for (size_t i = 0; i < face_detectors.size(); ++i) {
         ui->faceDetectorSelector->addItem(
-            QString::fromUtf8(face_detectors[i]->getDetectorName().c_str()),
+            QString::fromUtf8(face_detectors.getInfo(i).name.c_str()),
             QVariant(static_cast<int>(i)));
     }
     // Add None option
     ui->faceDetectorSelector->addItem("None", -1);
 
-    current_face_detector_index = 0;  // set default face detector method
+    // Set default face detector method. It is loaded in background
+    ui->faceDetectorSelector->setCurrentIndex(0);
+    faceDetectorSelector_activated();
 }
 
 
-// Load face landmark detectors
+// Register face landmark detectors. Models are only loaded when they are selected
 void MainWindow::loadFaceLandmarkDetectors() {
 
     // Landmark LBF
-    face_landmark_detectors.push_back(
-        std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorLBF()));
+    face_landmark_detectors.add({"LBF", {"models/alignment_lbf/lbfmodel.yaml"}},
+        [] { return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorLBF()); });
 
     // Landmark Kazemi
-    face_landmark_detectors.push_back(
-        std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorKazemi()));
+    face_landmark_detectors.add({"Kazemi", {"models/alignment_kazemi/face_landmark_model.dat"}},
+        [] { return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorKazemi()); });
 
     
     // Landmark Sy An CNN
-    face_landmark_detectors.push_back(
-        std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorSyanCNN()));
+    face_landmark_detectors.add({"SyanCNN", {"models/alignment_syan_cnn/AN01.model"}},
+        [] { return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorSyanCNN()); });
 
     
     // Landmark Sy An CNN 2
-    face_landmark_detectors.push_back(
-        std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorSyanCNN2()));
+    face_landmark_detectors.add({"SyanCNN 2", {"models/alignment_syan_cnn/AN02.pb"}},
+        [] { return std::shared_ptr<FaceLandmarkDetector>(new FaceLandmarkDetectorSyanCNN2()); });
         
 
     // Add detectors to selector box of GUI
     for (size_t i = 0; i < face_landmark_detectors.size(); ++i) {
         ui->faceLandmarkDetectorSelector->addItem(
-            QString::fromUtf8(face_landmark_detectors[i]->getDetectorName().c_str()),
+            QString::fromUtf8(face_landmark_detectors.getInfo(i).name.c_str()),
             QVariant(static_cast<int>(i)));
     }
     // Add None option
     ui->faceLandmarkDetectorSelector->addItem("None", -1);
 
-    current_face_landmark_detector_index = 0;  // set default face detector method
+    // Set default face landmark detector method. It is loaded in background
+    ui->faceLandmarkDetectorSelector->setCurrentIndex(0);
+    faceLandmarkDetectorSelector_activated();
 }
 
-void MainWindow::loadEffects() {
+std::vector<std::shared_ptr<ImageEffect>> MainWindow::createEffects() {
+    std::vector<std::shared_ptr<ImageEffect>> effects;
+
     // Effect: Debug
-    image_effects.push_back(
+    effects.push_back(
         std::shared_ptr<ImageEffect>(new EffectDebugInfo()));
 
     // Effect: Raining Cloud
-    image_effects.push_back(std::shared_ptr<ImageEffect>(new EffectCloud()));
+    effects.push_back(std::shared_ptr<ImageEffect>(new EffectCloud()));
 
     // Effect: Pink Glasses
-    image_effects.push_back(std::shared_ptr<ImageEffect>(new EffectPinkGlasses()));
+    effects.push_back(std::shared_ptr<ImageEffect>(new EffectPinkGlasses()));
 
     // Effect: Rabbit Ears
-    image_effects.push_back(std::shared_ptr<ImageEffect>(new EffectRabbitEars()));
+    effects.push_back(std::shared_ptr<ImageEffect>(new EffectRabbitEars()));
 
     // Effect: Tiger
-    image_effects.push_back(std::shared_ptr<ImageEffect>(new EffectTiger()));
+    effects.push_back(std::shared_ptr<ImageEffect>(new EffectTiger()));
 
     // Effect: Feather Hat
-    image_effects.push_back(std::shared_ptr<ImageEffect>(new EffectFeatherHat()));
+    effects.push_back(std::shared_ptr<ImageEffect>(new EffectFeatherHat()));
+
+    return effects;
+}
+
+void MainWindow::loadEffects() {
+    image_effects = createEffects();
 
     // Add "No Effect"
     QListWidgetItem *new_effect = new QListWidgetItem(
@@ -387,21 +873,57 @@ void MainWindow::loadEffects() {
 
 
 void MainWindow::refreshCams() {
+    refreshCamsAsync(nullptr);
+}
 
-    // Get the number of camera available
-    cv::VideoCapture temp_camera;
+// Enumerate cameras on the thread pool and update camera selector when done.
+// The cached camera list is shown at once in the meantime.
+// on_finished (if any) is called on GUI thread after the selector is updated
+void MainWindow::refreshCamsAsync(std::function<void()> on_finished) {
+    if (camera_enumerator.hasCache()) {
+        updateCameraSelector(camera_enumerator.getCachedDevices());
+    }
+
+    if (on_finished) {
+        camera_refresh_callbacks.push_back(on_finished);
+    }
+
+    // Already refreshing
+    if (camera_refresh_running) {
+        return;
+    }
+    camera_refresh_running = true;
+
+    QFutureWatcher<std::vector<ml_cam::CameraDevice>> *watcher =
+        new QFutureWatcher<std::vector<ml_cam::CameraDevice>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher] {
+        camera_refresh_running = false;
+        updateCameraSelector(watcher->result());
+        watcher->deleteLater();
+
+        std::vector<std::function<void()>> callbacks;
+        callbacks.swap(camera_refresh_callbacks);
+        for (size_t i = 0; i < callbacks.size(); ++i) {
+            callbacks[i]();
+        }
+    });
+
+    int in_use_index = (!frame_source && pipeline.isSourceOpened()) ? current_camera_index : -1;
+    watcher->setFuture(QtConcurrent::run([this, in_use_index] {
+        return camera_enumerator.enumerate(in_use_index);
+    }));
+}
+
+void MainWindow::updateCameraSelector(const std::vector<ml_cam::CameraDevice> & cameras) {
     ui->cameraSelector->clear();
-    for (int i = 0; i < MAX_CAMS; ++i) {
-        cv::VideoCapture temp_camera(i);
-        bool fail = (!temp_camera.isOpened());
-        temp_camera.release();
-
-        // If we can open camera, add new camera to list
-        if (!fail) {
-            ui->cameraSelector->addItem(
-            QString::fromUtf8((std::string("CAM") + std::to_string(i)).c_str()),
-            QVariant(static_cast<int>(i)));
+    for (size_t i = 0; i < cameras.size(); ++i) {
+        std::string label = std::string("CAM") + std::to_string(cameras[i].index);
+        if (!cameras[i].name.empty()) {
+            label += " - " + cameras[i].name;
         }
+        ui->cameraSelector->addItem(
+            QString::fromUtf8(label.c_str()),
+            QVariant(static_cast<int>(cameras[i].index)));
     }
 
     // Select current camera
@@ -412,11 +934,11 @@ void MainWindow::refreshCams() {
 }
 
 void MainWindow::setCurrentImage(const cv::Mat &img) {
-    std::lock_guard<std::mutex> guard(current_img_mutex);
-    current_img = img.clone();
+    // Finished frames are never written again, so the snapshot only takes
+    // a reference. The extra refcount also keeps the buffer out of the pool.
+    std::atomic_store(&current_img, std::make_shared<const cv::Mat>(img));
 }
 
-cv::Mat MainWindow::getCurrentImage() {
-    std::lock_guard<std::mutex> guard(current_img_mutex);
-    return current_img.clone();
+std::shared_ptr<const cv::Mat> MainWindow::getCurrentImage() {
+    return std::atomic_load(&current_img);
 }
\ No newline at end of file
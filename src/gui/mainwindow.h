@@ -10,10 +10,20 @@
 #include <QCloseEvent>
 #include <QMessageBox>
 #include <QShortcut>
+#include <QComboBox>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <SDL.h>
 
 #include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
 #include <mutex>
 #include <memory>
 #include "opencv2/opencv.hpp"
@@ -21,12 +31,15 @@
 #include "face_detector.h"
 #include "face_detector_cascade.h"
 #include "face_detector_ssd_resnet10.h"
+#include "face_detector_pooled.h"
+#include "face_detector_two_stage.h"
 
 #include "face_landmark_detector.h"
 #include "face_landmark_detector_kazemi.h"
 #include "face_landmark_detector_lbf.h"
 #include "face_landmark_detector_syan_cnn.h"
 #include "face_landmark_detector_syan_cnn_2.h"
+#include "face_landmark_detector_pooled.h"
 
 #include "image_effect.h"
 #include "effect_debug_info.h"
@@ -36,7 +49,15 @@
 #include "effect_tiger.h"
 #include "effect_pink_glasses.h"
 
+#include "command_line_options.h"
 #include "file_storage.h"
+#include "photo_writer.h"
+#include "sound_player.h"
+#include "model_registry.h"
+#include "model_pool.h"
+#include "camera_enumerator.h"
+#include "processing_pipeline.h"
+#include "pre_roll_buffer.h"
 
 
 namespace Ui {
@@ -48,64 +69,213 @@ class MainWindow : public QMainWindow
     Q_OBJECT
 
 public:
-    explicit MainWindow(QWidget *parent = 0);
+    explicit MainWindow(const ml_cam::CommandLineOptions & options = ml_cam::CommandLineOptions(),
+                        QWidget *parent = 0);
     ~MainWindow();
     void showCam();
 
+    // Use another frame source (video file, image sequence...) instead of
+    // the camera. Call before showCam()
+    void setFrameSource(std::shared_ptr<ml_cam::FrameSource> source);
+
+    // Process another camera at the same time as the selected one.
+    // Its preview is tiled next to the main one
+    void addCamera(int camera_index);
+
+    // Format and compression of captured photos
+    void setPhotoEncoding(const ml_cam::PhotoEncoding & encoding);
+
+    // FourCC name of the codec used to record videos (e.g. "MJPG", "mp4v")
+    void setVideoCodec(const std::string & codec);
+
+    // Keep camera frames in their native YUV layout (see ProcessingPipeline::start).
+    // Call before showCam()
+    void setNativeYUV(bool native_yuv);
+
+    // When the face detector runs, and whether it runs in background
+    // (the render path reuses the latest faces) or in the pipeline
+    void setDetectionSchedule(const ml_cam::DetectionSchedule & schedule, bool async_detection);
+
+    // Detect faces only around known faces, and scan the whole frame
+    // every full_scan_interval frames. 0 always scans the whole frame
+    void setROIDetection(int full_scan_interval);
+
+    // Skip face detection while the scene does not change. threshold is the
+    // mean gray level difference of a changed tile. 0 disables it
+    void setMotionGating(float threshold);
+
+    // Tile size (pixels) and overlap (ratio) of the tiled SSD detector.
+    // Call before the detector is loaded
+    void setSSDTiling(int tile_size, float tile_overlap);
+
+    // Keep the last seconds of displayed frames for instant replay,
+    // JPEG compressed or raw. 0 seconds disables it
+    void setPreRoll(double seconds, bool compress);
+
 protected:
     void closeEvent(QCloseEvent *event);
     void loadEffects();
 
 private slots:
     void captureBtn_clicked();
+    void recordBtn_clicked();
+    void saveReplayVideo();
+    void saveReplayBurst();
     void openLibraryBtn_clicked();
     void cameraSelector_activated();
     void faceDetectorSelector_activated();
     void faceLandmarkDetectorSelector_activated();
     void effectList_onselectionchange();
+    void flipCameraCheckBox_toggled(bool checked);
     void showAboutBox();
     void refreshCams();
+    void onFrameReady();
+    void onCameraLost();
+    void removeLostCameras();
+    void onPhotoSaved();
     
 private:
     Ui::MainWindow *ui;
 
     // Current image
     // When user click "Capture", we take photo here then have it
-    // to [Photos] folder
-    cv::Mat current_img;
-    std::mutex current_img_mutex;
+    // to [Photos] folder. Snapshots are immutable once published and
+    // swapped atomically, so readers just share a reference
+    std::shared_ptr<const cv::Mat> current_img;
 
     // File Storage
     ml_cam::FileStorage fs;
 
+    // Photos written by photo_writer, waiting for GUI thread to show them in library
+    struct SavedPhoto {
+        fs::path path;
+        std::shared_ptr<const cv::Mat> image;
+    };
+    std::mutex saved_photos_mutex;
+    std::vector<SavedPhoto> saved_photos;
+    void updateLibraryIcon(const cv::Mat & photo);
+
+    // Captured photos are encoded and written on its thread.
+    // Declared after saved_photos, so it is stopped first
+    ml_cam::PhotoWriter photo_writer;
+
 
     QGraphicsPixmapItem pixmap;
-    cv::VideoCapture video;
+
+    // Capture -> detection -> alignment -> render pipeline.
+    // GUI thread only displays finished frames from it
+    ml_cam::ProcessingPipeline pipeline;
+    std::atomic<bool> frame_ready_pending{false}; // A frame-ready event is queued for GUI thread
 
     // Face detectors
-    std::vector<std::shared_ptr<FaceDetector>> face_detectors;
+    // Models are registered by name and only loaded when selected
+    ml_cam::ModelRegistry<FaceDetector> face_detectors;
     int current_face_detector_index = -1; // Index of current face detector method in face_detectors
 
     // Face landmark detectors
-    std::vector<std::shared_ptr<FaceLandmarkDetector>> face_landmark_detectors;
+    ml_cam::ModelRegistry<FaceLandmarkDetector> face_landmark_detectors;
     int current_face_landmark_detector_index = -1; // Index of current face landmark detector method in face_detectors
 
+    // Memory budget for loaded models of each kind, in bytes. 0 means no limit.
+    // Models not used recently are unloaded when the budget is exceeded
+    size_t MODEL_MEMORY_BUDGET = 0;
+
+    // Models used by the pipelines of all cameras. Each detect call
+    // checks out its own instance from the pool of the selected model
+    std::shared_ptr<FaceDetector> face_detector;
+    std::shared_ptr<FaceLandmarkDetector> face_landmark_detector;
+
+    // Pool of each model, by registry index. Re-selecting a model reuses its
+    // pool while it is alive, so an instance is never leased from two pools
+    // at once. Held weakly, so unused models can still be unloaded
+    template <typename T>
+    struct PooledModel {
+        std::weak_ptr<T> prototype;
+        std::weak_ptr<ml_cam::ModelPool<T>> pool;
+    };
+    std::map<int, PooledModel<FaceDetector>> face_detector_pools;
+    std::map<int, PooledModel<FaceLandmarkDetector>> face_landmark_detector_pools;
+
+    template <typename T>
+    std::shared_ptr<ml_cam::ModelPool<T>> getModelPool(std::map<int, PooledModel<T>> & pools, int index,
+                                                       std::shared_ptr<T> instance);
+
+    // Names of models being loaded in background
+    std::set<std::string> loading_models;
+
+    template <typename T>
+    void loadModelAsync(ml_cam::ModelRegistry<T> & registry, int index, QComboBox * selector,
+                        std::function<void(std::shared_ptr<T>)> on_ready);
+
     // Photo effects
     std::vector<std::shared_ptr<ImageEffect>> image_effects;
     std::vector<int> selected_effect_indices; // Indices of selected effect in image_effects
+    static std::vector<std::shared_ptr<ImageEffect>> createEffects();
+    std::vector<std::shared_ptr<ImageEffect>> getSelectedEffects(const std::vector<std::shared_ptr<ImageEffect>> & effects);
+
+    // Other cameras processed at the same time as the selected one
+    struct CameraView {
+        int camera_index = 0;
+        std::unique_ptr<ml_cam::ProcessingPipeline> pipeline;
+        std::vector<std::shared_ptr<ImageEffect>> image_effects; // Effects keep per-face state, so every camera has its own
+        QGraphicsPixmapItem pixmap;
+    };
+    std::vector<std::unique_ptr<CameraView>> extra_cameras;
+
+    std::vector<ml_cam::ProcessingPipeline *> getPipelines();
+    void setupPipeline(ml_cam::ProcessingPipeline & target);
+    void layoutPreviews();
+    void setPixmapFrame(QGraphicsPixmapItem & item, const cv::Mat & frame);
+
+    // Records rendered frames of the main pipeline on its encoder thread
+    std::shared_ptr<ml_cam::VideoRecorder> video_recorder;
+    std::string video_codec = "MJPG";
+    bool record_button_recording = false; // Recording state shown on record button
+    void updateRecordButton();
+
+    // Shutter sound is loaded once, playing it does not block
+    std::unique_ptr<ml_cam::SoundPlayer> shutter_sound;
+
+    // Last seconds of displayed frames
+    std::unique_ptr<ml_cam::PreRollBuffer> pre_roll;
+
+    // Recycled buffers for the RGB display conversion
+    ml_cam::FrameBufferPool display_buffer_pool;
 
 
     // Camera to use
     int MAX_CAMS = 5; // Max number of camera supported. This number used to scan cameras
     int current_camera_index = 0;
     int selected_camera_index = 0;
+    bool native_yuv = false;
+    ml_cam::DetectionSchedule detection_schedule = ml_cam::DetectionSchedule::everyNFrames(10);
+    bool async_detection = true;
+    int roi_full_scan_interval = 0; // 0 when ROI detection is off
+    float motion_threshold = 0; // 0 when motion gating is off
+    int ssd_tile_size = 600;
+    float ssd_tile_overlap = 0.25f;
+
+    // Camera list is enumerated in background
+    ml_cam::CameraEnumerator camera_enumerator{MAX_CAMS};
+    bool camera_refresh_running = false;
+    std::vector<std::function<void()>> camera_refresh_callbacks;
+    void refreshCamsAsync(std::function<void()> on_finished);
+    void updateCameraSelector(const std::vector<ml_cam::CameraDevice> & cameras);
+
+    // Frame source used instead of the camera. nullptr to use the camera
+    std::shared_ptr<ml_cam::FrameSource> frame_source;
+    Timer::time_point_t pipeline_start_time;
+    bool startPipeline();
+    void printPipelineStats();
+    double getPipelineFrameRate(); // Average rendering rate since the pipeline started
 
 
 public:
     void loadFaceDetectors();
     void loadFaceLandmarkDetectors();
+    void displayFrame(const cv::Mat & frame);
     void setCurrentImage(const cv::Mat & img);
-    cv::Mat getCurrentImage();
+    std::shared_ptr<const cv::Mat> getCurrentImage();
     void playShutter();
 
 };
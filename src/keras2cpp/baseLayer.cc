@@ -1,4 +1,28 @@
 #include "baseLayer.h"
 namespace keras2cpp {
     BaseLayer::~BaseLayer() = default;
+
+    Tensor BaseLayer::batch(const Tensor& in) const noexcept {
+        kassert(in.ndim() >= 2);
+        size_t samples = in.dims_[0];
+        size_t sample_size = in.size() / samples;
+
+        Tensor out;
+        for (size_t i = 0; i != samples; ++i) {
+            Tensor sample;
+            sample.dims_.assign(in.dims_.begin() + 1, in.dims_.end());
+            sample.data_.assign(
+                in.begin() + cast(i * sample_size),
+                in.begin() + cast((i + 1) * sample_size));
+
+            Tensor result = (*this)(sample);
+            if (i == 0) {
+                out.dims_ = result.dims_;
+                out.dims_.insert(out.dims_.begin(), samples);
+                out.data_.reserve(out.size());
+            }
+            out.data_.insert(out.data_.end(), result.begin(), result.end());
+        }
+        return out;
+    }
 }
@@ -12,6 +12,10 @@ namespace keras2cpp {
         BaseLayer& operator=(BaseLayer&&) = default;
         virtual ~BaseLayer();
         virtual Tensor operator()(const Tensor& in) const noexcept = 0;
+
+        // Samples stacked along the first dimension. Layers without
+        // batch support run them one by one
+        virtual Tensor batch(const Tensor& in) const noexcept;
     };
     template <typename Derived>
     class Layer : public BaseLayer {
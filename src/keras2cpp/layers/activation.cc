@@ -93,5 +93,11 @@ namespace keras2cpp{
             }
             return out;
         }
+
+        // Element-wise (SoftMax works on the last dimension), so a batch is
+        // the same as a single sample
+        Tensor Activation::batch(const Tensor& in) const noexcept {
+            return (*this)(in);
+        }
     }
 }
\ No newline at end of file
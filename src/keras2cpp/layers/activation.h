@@ -19,6 +19,7 @@ namespace keras2cpp{
         public:
             Activation(Stream& file);
             Tensor operator()(const Tensor& in) const noexcept override;
+            Tensor batch(const Tensor& in) const noexcept override;
         };
     }
 }
\ No newline at end of file
@@ -21,5 +21,47 @@ namespace keras2cpp{
             }
             return activation_(tmp);
         }
+
+        Tensor Dense::batch(const Tensor& in) const noexcept {
+            if (in.ndim() != 2)
+                return (*this)(in);
+            kassert(in.dims_[1] == weights_.dims_[1]);
+            const auto ws = cast(weights_.dims_[1]);
+            const auto units = cast(weights_.dims_[0]);
+
+            // Weights outside, samples inside: every weight row is read once
+            // for the whole batch, and four samples are summed side by side.
+            // Each sum keeps the order of the single-sample inner_product,
+            // so the results are the same as running samples one by one
+            const auto samples = cast(in.dims_[0]);
+            Tensor tmp {in.dims_[0], weights_.dims_[0]};
+            const float* x = in.data_.data();
+            float* out = tmp.data_.data();
+            for (ptrdiff_t u = 0; u < units; ++u) {
+                const float* w = weights_.data_.data() + u * ws;
+                const float bias = biases_.data_[cast(u)];
+                ptrdiff_t s = 0;
+                for (; s + 4 <= samples; s += 4) {
+                    const float* x0 = x + s * ws;
+                    const float* x1 = x0 + ws;
+                    const float* x2 = x1 + ws;
+                    const float* x3 = x2 + ws;
+                    float a0 = bias, a1 = bias, a2 = bias, a3 = bias;
+                    for (ptrdiff_t k = 0; k < ws; ++k) {
+                        a0 = a0 + w[k] * x0[k];
+                        a1 = a1 + w[k] * x1[k];
+                        a2 = a2 + w[k] * x2[k];
+                        a3 = a3 + w[k] * x3[k];
+                    }
+                    out[s * units + u] = a0;
+                    out[(s + 1) * units + u] = a1;
+                    out[(s + 2) * units + u] = a2;
+                    out[(s + 3) * units + u] = a3;
+                }
+                for (; s < samples; ++s)
+                    out[s * units + u] = std::inner_product(w, w + ws, x + s * ws, bias);
+            }
+            return activation_(tmp);
+        }
     }
 }
\ No newline at end of file
@@ -9,6 +9,7 @@ namespace keras2cpp{
         public:
             Dense(Stream& file);
             Tensor operator()(const Tensor& in) const noexcept override;
+            Tensor batch(const Tensor& in) const noexcept override;
         };
     }
 }
@@ -4,5 +4,12 @@ namespace keras2cpp{
         Tensor Flatten::operator()(const Tensor& in) const noexcept {
             return Tensor(in).flatten();
         }
+
+        Tensor Flatten::batch(const Tensor& in) const noexcept {
+            kassert(in.ndim());
+            Tensor out(in);
+            out.dims_ = {in.dims_[0], in.size() / in.dims_[0]};
+            return out;
+        }
     }
 }
\ No newline at end of file
@@ -6,6 +6,7 @@ namespace keras2cpp{
         public:
             using Layer<Flatten>::Layer;
             Tensor operator()(const Tensor& in) const noexcept override;
+            Tensor batch(const Tensor& in) const noexcept override;
         };
     }
 }
\ No newline at end of file
@@ -55,4 +55,11 @@ namespace keras2cpp {
             out = (*layer)(out);
         return out;
     }
+
+    Tensor Model::batch(const Tensor& in) const noexcept {
+        Tensor out = in;
+        for (auto&& layer : layers_)
+            out = layer->batch(out);
+        return out;
+    }
 }
@@ -23,5 +23,6 @@ namespace keras2cpp {
     public:
         Model(Stream& file);
         Tensor operator()(const Tensor& in) const noexcept override;
+        Tensor batch(const Tensor& in) const noexcept override;
     };
 }
\ No newline at end of file
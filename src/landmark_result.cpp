@@ -38,6 +38,24 @@ bool LandMarkResult::haveLandmark() {
     return !landmark.empty();
 }
 
+int LandMarkResult::getTrackId() const {
+    return track_id;
+}
+
+int LandMarkResult::getTrackAge() const {
+    return track_age;
+}
+
+cv::Point2f LandMarkResult::getTrackVelocity() const {
+    return track_velocity;
+}
+
+void LandMarkResult::setTrack(int track_id, int track_age, const cv::Point2f & track_velocity) {
+    this->track_id = track_id;
+    this->track_age = track_age;
+    this->track_velocity = track_velocity;
+}
+
 
 std::vector<cv::Point2f> LandMarkResult::getMouth() {
     if (landmark.empty()) return landmark;
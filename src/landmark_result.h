@@ -12,6 +12,11 @@ private:
     float face_rect_confidence;
     std::vector<cv::Point2f> landmark;
 
+    // Identity of this face across frames. -1 if not assigned
+    int track_id = -1;
+    int track_age = 0; // Number of frames this face has been tracked
+    cv::Point2f track_velocity; // Motion of face center in pixels per frame
+
     // Indices of face parts.
     // The first element is start index. The second element is the last index
     const int MOUTH_IDX[2] = { 48, 68 };
@@ -32,6 +37,9 @@ public:
         face_rect = other.face_rect;
         face_rect_confidence = other.face_rect_confidence;
         landmark = other.landmark;
+        track_id = other.track_id;
+        track_age = other.track_age;
+        track_velocity = other.track_velocity;
         return *this;
     }
 
@@ -44,6 +52,11 @@ public:
     void setFaceLandmark(std::vector<cv::Point2f> & landmark);
     bool haveLandmark();
 
+    int getTrackId() const;
+    int getTrackAge() const;
+    cv::Point2f getTrackVelocity() const;
+    void setTrack(int track_id, int track_age, const cv::Point2f & track_velocity);
+
     std::vector<cv::Point2f> getMouth();
     std::vector<cv::Point2f> getRightEyeBrow();
     std::vector<cv::Point2f> getLeftEyeBrow();
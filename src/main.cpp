@@ -1,16 +1,175 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include <stdlib.h>
+#include <algorithm>
 #include <iostream>
 #include "filesystem_include.h"
 #include "framelesswindow.h"
 #include "DarkStyle.h"
 #include "mainwindow.h"
+#include "command_line_options.h"
 #include "file_storage.h"
+#include "photo_writer.h"
+#include "video_recorder.h"
+#include "video_file_frame_source.h"
+#include "image_sequence_frame_source.h"
+#include "synthetic_frame_source.h"
 
 
+// Read options from command line
+ml_cam::CommandLineOptions parseCommandLine(const QStringList & arguments) {
+    ml_cam::CommandLineOptions options;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("FaceCam");
+    parser.addHelpOption();
+
+    QCommandLineOption video_option("video", "Read frames from a video file.", "file");
+    QCommandLineOption images_option("images", "Read frames from the images of a directory.", "dir");
+    QCommandLineOption synthetic_option("synthetic", "Generate frames with moving faces.");
+    QCommandLineOption resolution_option("resolution", "Resolution of generated frames.", "WxH", "640x480");
+    QCommandLineOption faces_option("faces", "Number of generated faces.", "count", "1");
+    QCommandLineOption sprite_option("sprite", "Image used as generated face.", "file");
+    QCommandLineOption frames_option("frames", "Number of generated frames. 0 means no limit.", "count", "0");
+    QCommandLineOption fps_option("fps", "Frame rate of image sequence and generated frames.", "fps", "30");
+    QCommandLineOption free_run_option("free-run",
+        "Process frames as fast as possible without dropping any, "
+        "then print throughput and exit. Files are not looped.");
+    parser.addOption(video_option);
+    parser.addOption(images_option);
+    parser.addOption(synthetic_option);
+    parser.addOption(resolution_option);
+    parser.addOption(faces_option);
+    parser.addOption(sprite_option);
+    parser.addOption(frames_option);
+    parser.addOption(fps_option);
+    parser.addOption(free_run_option);
+    QCommandLineOption cameras_option("cameras",
+        "Also process these cameras, tiled next to the selected one (e.g. 1,2).", "indices");
+    parser.addOption(cameras_option);
+    QCommandLineOption photo_format_option("photo-format",
+        "Format of captured photos: png, jpg or webp.", "format", "png");
+    QCommandLineOption photo_quality_option("photo-quality",
+        "Quality of JPEG and WebP photos (1-100).", "quality", "95");
+    QCommandLineOption png_compression_option("png-compression",
+        "Compression level of PNG photos (0-9). Lower is faster.", "level", "3");
+    parser.addOption(photo_format_option);
+    parser.addOption(photo_quality_option);
+    parser.addOption(png_compression_option);
+    QCommandLineOption video_codec_option("video-codec",
+        "FourCC of the codec of recorded videos (e.g. MJPG, XVID, mp4v).", "fourcc", "MJPG");
+    parser.addOption(video_codec_option);
+    QCommandLineOption pre_roll_option("pre-roll",
+        "Seconds of frames kept for instant replay. 0 disables it.", "seconds", "5");
+    QCommandLineOption pre_roll_raw_option("pre-roll-raw",
+        "Keep replay frames uncompressed (more memory, less CPU).");
+    parser.addOption(pre_roll_option);
+    parser.addOption(pre_roll_raw_option);
+    QCommandLineOption native_yuv_option("native-yuv",
+        "Keep camera frames in YUYV / NV12. Gray images come from the Y plane "
+        "and BGR is converted only once per frame.");
+    parser.addOption(native_yuv_option);
+    QCommandLineOption detect_every_option("detect-every",
+        "Run the face detector every <frames> frames. Faces are tracked in between.",
+        "frames", "10");
+    QCommandLineOption detect_rate_option("detect-rate",
+        "Run the face detector at most <hz> times per second instead of every N frames.", "hz");
+    QCommandLineOption sync_detection_option("sync-detection",
+        "Detect faces in the pipeline instead of in background. "
+        "Frames wait for the detector when it is due.");
+    parser.addOption(detect_every_option);
+    parser.addOption(detect_rate_option);
+    parser.addOption(sync_detection_option);
+    QCommandLineOption roi_detection_option("roi-detection",
+        "Detect faces only around the faces of the last frame, and scan "
+        "the whole frame for new faces every <frames> frames.", "frames");
+    parser.addOption(roi_detection_option);
+    QCommandLineOption motion_gating_option("motion-gating",
+        "Skip face detection while the scene is static, and detect only on changed "
+        "regions when motion is local. <threshold> is the mean gray level "
+        "difference of a changed tile (e.g. 4).", "threshold");
+    parser.addOption(motion_gating_option);
+    QCommandLineOption ssd_tile_size_option("ssd-tile-size",
+        "Tile size of the tiled SSD detector. Larger frames are split into tiles.", "pixels", "600");
+    QCommandLineOption ssd_tile_overlap_option("ssd-tile-overlap",
+        "Overlap of the tiles of the tiled SSD detector (ratio of tile size).", "ratio", "0.25");
+    parser.addOption(ssd_tile_size_option);
+    parser.addOption(ssd_tile_overlap_option);
+    parser.process(arguments);
+
+    bool free_run = parser.isSet(free_run_option);
+    double fps = parser.value(fps_option).toDouble();
+
+    std::shared_ptr<ml_cam::FrameSource> source;
+    if (parser.isSet(video_option)) {
+        source = std::make_shared<ml_cam::VideoFileFrameSource>(
+            parser.value(video_option).toStdString(), !free_run);
+    } else if (parser.isSet(images_option)) {
+        source = std::make_shared<ml_cam::ImageSequenceFrameSource>(
+            parser.value(images_option).toStdString(), fps, !free_run);
+    } else if (parser.isSet(synthetic_option)) {
+        QStringList size = parser.value(resolution_option).split('x');
+        cv::Size resolution(640, 480);
+        if (size.size() == 2) {
+            resolution = cv::Size(size[0].toInt(), size[1].toInt());
+        }
+        source = std::make_shared<ml_cam::SyntheticFrameSource>(
+            resolution, fps, parser.value(faces_option).toInt(),
+            parser.value(sprite_option).toStdString(),
+            parser.value(frames_option).toULongLong());
+    }
+
+    if (source) {
+        source->setFreeRun(free_run);
+    }
+    options.frame_source = source;
+
+    QStringList camera_indices = parser.value(cameras_option).split(',', QString::SkipEmptyParts);
+    for (int i = 0; i < camera_indices.size(); ++i) {
+        bool ok = false;
+        int camera_index = camera_indices[i].trimmed().toInt(&ok);
+        if (ok) {
+            options.extra_cameras.push_back(camera_index);
+        }
+    }
+
+    if (!ml_cam::PhotoEncoding::parseFormat(parser.value(photo_format_option).toStdString(),
+                                            options.photo_encoding.format)) {
+        std::cerr << "Unknown photo format: " << parser.value(photo_format_option).toStdString()
+                  << ". Using png." << std::endl;
+    }
+    options.photo_encoding.quality = parser.value(photo_quality_option).toInt();
+    options.photo_encoding.png_compression = parser.value(png_compression_option).toInt();
+
+    std::string video_codec = parser.value(video_codec_option).toStdString();
+    if (ml_cam::VideoRecorder::parseCodec(video_codec) == -1) {
+        std::cerr << "Video codec must be 4 characters: " << video_codec
+                  << ". Using MJPG." << std::endl;
+    } else {
+        options.video_codec = video_codec;
+    }
+
+    options.pre_roll_seconds = parser.value(pre_roll_option).toDouble();
+    options.pre_roll_raw = parser.isSet(pre_roll_raw_option);
+    options.native_yuv = parser.isSet(native_yuv_option);
+    options.detect_every_frames = std::max(1, parser.value(detect_every_option).toInt());
+    options.detect_rate = parser.isSet(detect_rate_option) ?
+        std::max(0.1f, parser.value(detect_rate_option).toFloat()) : 0;
+    options.sync_detection = parser.isSet(sync_detection_option);
+    options.roi_full_scan_interval = parser.isSet(roi_detection_option) ?
+        std::max(1, parser.value(roi_detection_option).toInt()) : 0;
+    options.motion_threshold = parser.isSet(motion_gating_option) ?
+        std::max(0.1f, parser.value(motion_gating_option).toFloat()) : 0;
+    options.ssd_tile_size = std::max(100, parser.value(ssd_tile_size_option).toInt());
+    options.ssd_tile_overlap = parser.value(ssd_tile_overlap_option).toFloat();
+
+    return options;
+}
+
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
 
+    ml_cam::CommandLineOptions options = parseCommandLine(a.arguments());
+
     // Init file storage
     ml_cam::FileStorage fs;
     fs.initStorage();
@@ -24,12 +183,15 @@ int main(int argc, char *argv[]) {
     framelessWindow.setWindowIcon(a.style()->standardIcon(QStyle::SP_DesktopIcon));
     
     // Create our mainwindow instance
-    MainWindow *mainWindow = new MainWindow;
+    MainWindow *mainWindow = new MainWindow(options);
 
     // Add the mainwindow to our custom frameless window
     framelessWindow.setContent(mainWindow);
     framelessWindow.show();
     mainWindow->showCam();
+    for (size_t i = 0; i < options.extra_cameras.size(); ++i) {
+        mainWindow->addCamera(options.extra_cameras[i]);
+    }
 
     return a.exec();
 }
@@ -0,0 +1,147 @@
+#if !defined(MODEL_POOL_H)
+#define MODEL_POOL_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ml_cam {
+
+// Pool of instances of one model (face detector, landmark detector).
+// Model instances keep state between calls (cv::dnn::Net keeps its input blob,
+// cv::CascadeClassifier is not reentrant), so a thread checks out an instance,
+// uses it alone and returns it. More instances are created with the factory
+// only when all existing ones are in use at the same time. The factory
+// usually clones the first instance, sharing its read-only model data.
+// The pool must outlive its leases.
+template <typename T>
+class ModelPool {
+   public:
+    typedef std::function<std::shared_ptr<T>()> Factory;
+
+    // Instance checked out of the pool. It goes back to the pool when the lease is destroyed
+    class Lease {
+       private:
+        friend class ModelPool<T>;
+        ModelPool<T> * pool = nullptr;
+        std::shared_ptr<T> instance;
+
+        Lease(ModelPool<T> * pool, std::shared_ptr<T> instance) : pool(pool), instance(instance) {}
+
+       public:
+        Lease() {}
+        Lease(const Lease &) = delete;
+        Lease & operator=(const Lease &) = delete;
+
+        Lease(Lease && other) noexcept : pool(other.pool), instance(std::move(other.instance)) {
+            other.pool = nullptr;
+        }
+
+        Lease & operator=(Lease && other) noexcept {
+            if (this != &other) {
+                release();
+                pool = other.pool;
+                instance = std::move(other.instance);
+                other.pool = nullptr;
+            }
+            return *this;
+        }
+
+        ~Lease() { release(); }
+
+        // Return instance to the pool before the lease is destroyed
+        void release() {
+            if (pool && instance) {
+                pool->checkin(instance);
+            }
+            pool = nullptr;
+            instance.reset();
+        }
+
+        T * get() const { return instance.get(); }
+        T * operator->() const { return instance.get(); }
+        T & operator*() const { return *instance; }
+        explicit operator bool() const { return static_cast<bool>(instance); }
+    };
+
+   private:
+    Factory factory;
+    size_t max_instances;  // 0 means no limit
+
+    std::mutex mutex;
+    std::condition_variable instance_returned;
+    std::vector<std::shared_ptr<T>> idle_instances;
+    size_t instance_count = 0;
+
+    void checkin(std::shared_ptr<T> instance) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            idle_instances.push_back(instance);
+        }
+        instance_returned.notify_one();
+    }
+
+   public:
+    // prototype is the first instance of the pool
+    ModelPool(std::shared_ptr<T> prototype, Factory factory, size_t max_instances = 0)
+        : factory(factory), max_instances(max_instances) {
+        if (prototype) {
+            idle_instances.push_back(prototype);
+            instance_count = 1;
+        }
+    }
+
+    // Take an idle instance. Create one if all are in use,
+    // or wait for one to be returned when the pool cannot grow.
+    // The lease is empty if the pool has no instance and cannot create one
+    Lease checkout() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            if (!idle_instances.empty()) {
+                std::shared_ptr<T> instance = idle_instances.back();
+                idle_instances.pop_back();
+                return Lease(this, instance);
+            }
+
+            bool can_grow = factory && (max_instances == 0 || instance_count < max_instances);
+            if (can_grow) {
+                ++instance_count;
+
+                // Create without holding the lock. Loading a model can take seconds
+                lock.unlock();
+                std::shared_ptr<T> instance = factory();
+                lock.lock();
+
+                if (instance) {
+                    return Lease(this, instance);
+                }
+
+                // Cannot create more instances. Wait for existing ones from now on
+                --instance_count;
+                if (instance_count == 0) {
+                    return Lease();
+                }
+                max_instances = instance_count;
+                continue;
+            }
+
+            instance_returned.wait(lock);
+        }
+    }
+
+    size_t getInstanceCount() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return instance_count;
+    }
+
+    size_t getIdleCount() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return idle_instances.size();
+    }
+};
+
+}  // namespace ml_cam
+
+#endif  // MODEL_POOL_H
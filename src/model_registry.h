@@ -0,0 +1,158 @@
+#if !defined(MODEL_REGISTRY_H)
+#define MODEL_REGISTRY_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "filesystem_include.h"
+#include "timer.h"
+
+namespace ml_cam {
+
+// Name and metadata of a model. Known without loading the model
+struct ModelInfo {
+    std::string name;
+    std::vector<std::string> model_files;  // Files loaded by the model, used to estimate its memory
+    size_t network_count = 1;  // Networks the model builds from its files (e.g. one per worker thread)
+};
+
+// List of models (face detectors, landmark detectors) by name and metadata.
+// A model is only instantiated the first time it is requested.
+// With a memory budget, models not used recently are unloaded when the
+// loaded models need more memory than the budget.
+template <typename T>
+class ModelRegistry {
+   public:
+    typedef std::function<std::shared_ptr<T>()> Factory;
+
+   private:
+    struct Entry {
+        ModelInfo info;
+        Factory factory;
+        std::shared_ptr<T> instance;
+        Timer::time_point_t last_used;
+        size_t memory_size = 0;  // Estimated from model files
+    };
+
+    std::vector<Entry> entries;
+    size_t memory_budget = 0;  // Bytes. 0 means no limit
+    mutable std::mutex mutex;
+
+    static size_t estimateMemorySize(const ModelInfo & info) {
+        size_t size = 0;
+        for (size_t i = 0; i < info.model_files.size(); ++i) {
+            std::error_code ec;
+            uintmax_t file_size = fs::file_size(fs::absolute(info.model_files[i]), ec);
+            if (!ec) {
+                size += static_cast<size_t>(file_size);
+            }
+        }
+        return size * std::max<size_t>(1, info.network_count);
+    }
+
+    // Unload least recently used models until loaded models fit into budget.
+    // Never unload the model at keep_index. Caller must hold the mutex
+    void enforceMemoryBudget(size_t keep_index) {
+        if (memory_budget == 0) return;
+
+        while (getLoadedMemorySizeLocked() > memory_budget) {
+            int lru_index = -1;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (i == keep_index || !entries[i].instance) continue;
+                if (lru_index < 0 || entries[i].last_used < entries[lru_index].last_used) {
+                    lru_index = static_cast<int>(i);
+                }
+            }
+            if (lru_index < 0) break;
+            entries[lru_index].instance.reset();
+        }
+    }
+
+    size_t getLoadedMemorySizeLocked() const {
+        size_t size = 0;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].instance) size += entries[i].memory_size;
+        }
+        return size;
+    }
+
+   public:
+    ModelRegistry() {}
+
+    // Register a model. Return its index
+    int add(const ModelInfo & info, Factory factory) {
+        std::lock_guard<std::mutex> guard(mutex);
+        Entry entry;
+        entry.info = info;
+        entry.factory = factory;
+        entry.memory_size = estimateMemorySize(info);
+        entries.push_back(entry);
+        return static_cast<int>(entries.size()) - 1;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return entries.size();
+    }
+
+    ModelInfo getInfo(int index) const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return entries[index].info;
+    }
+
+    bool isLoaded(int index) const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return static_cast<bool>(entries[index].instance);
+    }
+
+    // Get model, instantiating it on first use
+    std::shared_ptr<T> get(int index) {
+        Factory factory;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            Entry & entry = entries[index];
+            entry.last_used = Timer::getCurrentTime();
+            if (entry.instance) {
+                return entry.instance;
+            }
+            factory = entry.factory;
+        }
+
+        // Load without holding the lock. Loading a model can take seconds
+        std::shared_ptr<T> instance = factory();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        Entry & entry = entries[index];
+        if (!entry.instance) {  // Another thread may have loaded it meanwhile
+            entry.instance = instance;
+        }
+        entry.last_used = Timer::getCurrentTime();
+        enforceMemoryBudget(index);
+        return entry.instance;
+    }
+
+    // Drop registry's reference to a model.
+    // Memory is freed when nobody else uses the instance
+    void unload(int index) {
+        std::lock_guard<std::mutex> guard(mutex);
+        entries[index].instance.reset();
+    }
+
+    void setMemoryBudget(size_t bytes) {
+        std::lock_guard<std::mutex> guard(mutex);
+        memory_budget = bytes;
+        enforceMemoryBudget(entries.size());
+    }
+
+    size_t getLoadedMemorySize() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return getLoadedMemorySizeLocked();
+    }
+};
+
+}  // namespace ml_cam
+
+#endif  // MODEL_REGISTRY_H
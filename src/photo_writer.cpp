@@ -0,0 +1,148 @@
+#include "photo_writer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+
+using namespace ml_cam;
+
+std::string PhotoEncoding::getExtension() const {
+    switch (format) {
+        case PhotoFormat::JPEG:
+            return ".jpg";
+        case PhotoFormat::WEBP:
+            return ".webp";
+        default:
+            return ".png";
+    }
+}
+
+std::vector<int> PhotoEncoding::getWriteParams() const {
+    switch (format) {
+        case PhotoFormat::JPEG:
+            return {cv::IMWRITE_JPEG_QUALITY, std::max(1, std::min(100, quality))};
+        case PhotoFormat::WEBP:
+            return {cv::IMWRITE_WEBP_QUALITY, std::max(1, std::min(100, quality))};
+        default:
+            return {cv::IMWRITE_PNG_COMPRESSION, std::max(0, std::min(9, png_compression))};
+    }
+}
+
+bool PhotoEncoding::parseFormat(const std::string & name, PhotoFormat & format) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (lower == "png") {
+        format = PhotoFormat::PNG;
+    } else if (lower == "jpg" || lower == "jpeg") {
+        format = PhotoFormat::JPEG;
+    } else if (lower == "webp") {
+        format = PhotoFormat::WEBP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+PhotoWriter::PhotoWriter(size_t max_pending_bytes)
+    : max_pending_bytes(max_pending_bytes) {
+    worker = std::thread(&PhotoWriter::workerLoop, this);
+}
+
+PhotoWriter::~PhotoWriter() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void PhotoWriter::setEncoding(const PhotoEncoding & encoding) {
+    std::lock_guard<std::mutex> guard(mutex);
+    this->encoding = encoding;
+}
+
+PhotoEncoding PhotoWriter::getEncoding() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return encoding;
+}
+
+size_t PhotoWriter::getImageBytes(const cv::Mat & image) {
+    return image.total() * image.elemSize();
+}
+
+bool PhotoWriter::write(std::shared_ptr<const cv::Mat> image, const fs::path & path,
+                        Callback on_finished) {
+    if (!image || image->empty()) {
+        return false;
+    }
+
+    size_t bytes = getImageBytes(*image);
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (stopping) {
+            return false;
+        }
+        // Always accept one photo, even if it is bigger than the limit
+        if (pending_bytes > 0 && pending_bytes + bytes > max_pending_bytes) {
+            ++rejected_count;
+            return false;
+        }
+        pending_bytes += bytes;
+        jobs.push_back(Job{image, path, encoding, on_finished});
+    }
+    job_ready.notify_one();
+    return true;
+}
+
+size_t PhotoWriter::getPendingCount() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return jobs.size();
+}
+
+size_t PhotoWriter::getPendingBytes() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return pending_bytes;
+}
+
+size_t PhotoWriter::getRejectedCount() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return rejected_count;
+}
+
+void PhotoWriter::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        job_ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+        // Queued photos are still written when stopping
+        if (jobs.empty()) {
+            break;
+        }
+
+        Job job = jobs.front();
+        jobs.pop_front();
+
+        // Encode without holding the lock
+        lock.unlock();
+
+        bool success = false;
+        try {
+            success = cv::imwrite(job.path.string(), *job.image, job.encoding.getWriteParams());
+        } catch (const cv::Exception & e) {
+            std::cerr << e.what() << std::endl;
+        }
+        if (!success) {
+            std::cerr << "Could not write photo " << job.path << std::endl;
+        }
+
+        if (job.on_finished) {
+            job.on_finished(job.path, success);
+        }
+
+        lock.lock();
+        pending_bytes -= getImageBytes(*job.image);
+    }
+}
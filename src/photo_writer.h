@@ -0,0 +1,94 @@
+#if !defined(PHOTO_WRITER_H)
+#define PHOTO_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "filesystem_include.h"
+
+namespace ml_cam {
+
+enum class PhotoFormat {
+    PNG,
+    JPEG,
+    WEBP
+};
+
+// How photos are encoded
+struct PhotoEncoding {
+    PhotoFormat format = PhotoFormat::PNG;
+    int png_compression = 3;  // 0 (fastest, biggest) to 9 (slowest, smallest)
+    int quality = 95;         // JPEG and WebP quality, 1 to 100
+
+    // File extension with the dot, e.g. ".png"
+    std::string getExtension() const;
+
+    // Parameters for cv::imwrite()
+    std::vector<int> getWriteParams() const;
+
+    // Parse "png", "jpg"/"jpeg" or "webp". Return false if the name is unknown
+    static bool parseFormat(const std::string & name, PhotoFormat & format);
+};
+
+// Encode and write photos on a background thread, so taking a photo
+// does not stall the GUI. Queued images are not copied: they must not be
+// modified after being submitted.
+class PhotoWriter {
+   public:
+    // Called on the writer thread after a photo was written (or failed)
+    typedef std::function<void(const fs::path & path, bool success)> Callback;
+
+   private:
+    struct Job {
+        std::shared_ptr<const cv::Mat> image;
+        fs::path path;
+        PhotoEncoding encoding;
+        Callback on_finished;
+    };
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::deque<Job> jobs;
+    bool stopping = false;
+
+    PhotoEncoding encoding;
+
+    // Memory held by queued images is limited to max_pending_bytes
+    size_t max_pending_bytes;
+    size_t pending_bytes = 0;
+    size_t rejected_count = 0;
+
+    static size_t getImageBytes(const cv::Mat & image);
+    void workerLoop();
+
+   public:
+    PhotoWriter(size_t max_pending_bytes = 256 * 1024 * 1024);
+
+    // Write all queued photos, then stop the writer thread
+    ~PhotoWriter();
+
+    void setEncoding(const PhotoEncoding & encoding);
+    PhotoEncoding getEncoding();
+
+    // Queue a photo to be written to path with the current encoding.
+    // Return false (and do not call on_finished) if the image is empty or
+    // the queue is over its memory limit
+    bool write(std::shared_ptr<const cv::Mat> image, const fs::path & path,
+               Callback on_finished = nullptr);
+
+    size_t getPendingCount();
+    size_t getPendingBytes();
+    size_t getRejectedCount();
+};
+
+}  // namespace ml_cam
+
+#endif  // PHOTO_WRITER_H
@@ -0,0 +1,101 @@
+#include "async_face_detector.h"
+
+using namespace ml_cam;
+
+AsyncFaceDetector::AsyncFaceDetector() {
+    worker = std::thread(&AsyncFaceDetector::workerLoop, this);
+}
+
+AsyncFaceDetector::~AsyncFaceDetector() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool AsyncFaceDetector::submit(std::shared_ptr<FaceDetector> detector, const cv::Mat & frame, uint64_t sequence,
+                               PixelFormat format, const DetectionScope & scope) {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (busy || stopping) {
+            return false;
+        }
+        busy = true;
+        job_detector = detector;
+        // Never overwrite the frame of the latest result
+        job_frame = buffer_pool ? buffer_pool->copy(frame) : frame.clone();
+        job_format = format;
+        job_scope = scope;
+        job_sequence = sequence;
+    }
+    job_ready.notify_one();
+    return true;
+}
+
+void AsyncFaceDetector::setBufferPool(std::shared_ptr<FrameBufferPool> buffer_pool) {
+    std::lock_guard<std::mutex> guard(mutex);
+    this->buffer_pool = buffer_pool;
+}
+
+bool AsyncFaceDetector::isBusy() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return busy;
+}
+
+bool AsyncFaceDetector::getLatestResult(DetectionResult & result) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!has_result) {
+        return false;
+    }
+    result = latest_result;
+    return true;
+}
+
+void AsyncFaceDetector::clearResult() {
+    std::lock_guard<std::mutex> guard(mutex);
+    has_result = false;
+    latest_result = DetectionResult();
+    ++generation;
+}
+
+void AsyncFaceDetector::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        job_ready.wait(lock, [this] { return stopping || job_detector != nullptr; });
+        if (stopping) {
+            break;
+        }
+
+        std::shared_ptr<FaceDetector> detector = job_detector;
+        job_detector = nullptr;
+        cv::Mat frame = job_frame;
+        PixelFormat format = job_format;
+        DetectionScope scope = job_scope;
+        uint64_t sequence = job_sequence;
+        uint64_t job_generation = generation;
+
+        // Detect without holding the lock
+        lock.unlock();
+
+        DetectionResult result;
+        result.sequence = sequence;
+        result.context = std::make_shared<FrameContext>(frame, format);
+        Timer::time_point_t start_time = Timer::getCurrentTime();
+        result.faces = detector->detectInScope(*result.context, scope);
+        result.duration = Timer::calcTimePassed(start_time);
+
+        lock.lock();
+
+        // Do not replace a result of a newer frame
+        if (job_generation == generation &&
+            (!has_result || result.sequence >= latest_result.sequence)) {
+            latest_result = std::move(result);
+            has_result = true;
+        }
+        busy = false;
+    }
+}
@@ -0,0 +1,79 @@
+#if !defined(ASYNC_FACE_DETECTOR_H)
+#define ASYNC_FACE_DETECTOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "face_detector.h"
+#include "frame_buffer_pool.h"
+#include "frame_context.h"
+#include "landmark_result.h"
+#include "timer.h"
+
+namespace ml_cam {
+
+// Result of one face detector run
+struct DetectionResult {
+    uint64_t sequence = 0;  // Sequence number of the frame the detector ran on
+    std::shared_ptr<FrameContext> context;  // The frame the detector ran on
+    std::vector<LandMarkResult> faces;
+    Timer::time_duration_t duration = 0;
+};
+
+// Run face detection on a background worker at its own rate.
+// The caller submits a frame when it wants fresh results and keeps using
+// the latest available result in the meantime.
+class AsyncFaceDetector {
+   private:
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    bool stopping = false;
+    bool busy = false;  // A job is queued or running
+    uint64_t generation = 0;  // Increased by clearResult() to discard results of running jobs
+
+    std::shared_ptr<FrameBufferPool> buffer_pool;  // For copies of submitted frames
+
+    // Pending job
+    std::shared_ptr<FaceDetector> job_detector;
+    cv::Mat job_frame;
+    PixelFormat job_format = PixelFormat::BGR;
+    DetectionScope job_scope;
+    uint64_t job_sequence = 0;
+
+    // Latest result
+    bool has_result = false;
+    DetectionResult latest_result;
+
+    void workerLoop();
+
+   public:
+    AsyncFaceDetector();
+    ~AsyncFaceDetector();
+
+    // Submit a frame (in the given pixel format) to detect faces on. The frame is copied.
+    // Only the part of the frame in scope is searched (FaceDetector::detectInScope).
+    // Return false (and do nothing) if the worker is still busy
+    bool submit(std::shared_ptr<FaceDetector> detector, const cv::Mat & frame, uint64_t sequence,
+                PixelFormat format = PixelFormat::BGR, const DetectionScope & scope = DetectionScope());
+
+    bool isBusy();
+
+    // Copy submitted frames into recycled buffers
+    void setBufferPool(std::shared_ptr<FrameBufferPool> buffer_pool);
+
+    // Get latest result. Return false if there is no result yet
+    bool getLatestResult(DetectionResult & result);
+
+    // Forget the latest result (e.g. when detector is changed)
+    void clearResult();
+};
+
+}  // namespace ml_cam
+
+#endif  // ASYNC_FACE_DETECTOR_H
@@ -0,0 +1,127 @@
+#if !defined(BOUNDED_QUEUE_H)
+#define BOUNDED_QUEUE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace ml_cam {
+
+// What to do when a producer pushes into a full queue
+enum class DropPolicy {
+    Block,       // Wait until the consumer takes an item
+    DropOldest,  // Throw away the oldest queued item to make room (lowest latency)
+    DropNewest   // Throw away the item being pushed (keep what is already queued)
+};
+
+// Thread-safe FIFO queue with a fixed capacity.
+// Used to connect the stages of the processing pipeline.
+template <typename T>
+class BoundedQueue {
+   private:
+    std::deque<T> items;
+    size_t capacity;
+    DropPolicy drop_policy;
+    bool closed = false;
+    size_t dropped_count = 0;  // Number of items dropped because the queue was full
+
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+   public:
+    BoundedQueue(size_t capacity = 2, DropPolicy drop_policy = DropPolicy::DropOldest)
+        : capacity(capacity > 0 ? capacity : 1), drop_policy(drop_policy) {}
+
+    // Push an item into the queue.
+    // Return false if the queue was closed or the pushed item was dropped
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (items.size() >= capacity) {
+            switch (drop_policy) {
+                case DropPolicy::Block:
+                    not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+                    break;
+                case DropPolicy::DropOldest:
+                    items.pop_front();
+                    ++dropped_count;
+                    break;
+                case DropPolicy::DropNewest:
+                    ++dropped_count;
+                    return false;
+            }
+        }
+
+        if (closed) return false;
+
+        items.push_back(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Take the oldest item. Block until an item is available.
+    // Return false if the queue was closed and has no item left
+    bool pop(T & item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        return takeFront(lock, item);
+    }
+
+    // Take the oldest item, waiting at most timeout_ms miliseconds.
+    // Return false if there is no item
+    bool pop(T & item, long long timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                           [this] { return closed || !items.empty(); });
+        return takeFront(lock, item);
+    }
+
+    // Wake up all waiting producers and consumers. Pushes are refused after this
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            closed = true;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    // Make a closed queue usable again, dropping anything left in it
+    void reopen() {
+        std::lock_guard<std::mutex> guard(mutex);
+        items.clear();
+        closed = false;
+    }
+
+    void setDropPolicy(DropPolicy drop_policy) {
+        std::lock_guard<std::mutex> guard(mutex);
+        this->drop_policy = drop_policy;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return items.size();
+    }
+
+    size_t getDroppedCount() const {
+        std::lock_guard<std::mutex> guard(mutex);
+        return dropped_count;
+    }
+
+   private:
+    bool takeFront(std::unique_lock<std::mutex> & lock, T & item) {
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+};
+
+}  // namespace ml_cam
+
+#endif  // BOUNDED_QUEUE_H
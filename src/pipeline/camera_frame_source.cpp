@@ -0,0 +1,88 @@
+#include "camera_frame_source.h"
+
+using namespace ml_cam;
+
+CameraFrameSource::CameraFrameSource(int camera_index, bool native_yuv)
+    : camera_index(camera_index), native_yuv(native_yuv) {}
+
+CameraFrameSource::~CameraFrameSource() { close(); }
+
+int CameraFrameSource::getCameraIndex() { return camera_index; }
+
+bool CameraFrameSource::openSource() {
+    if (!video.open(camera_index)) {
+        return false;
+    }
+
+    pixel_format = PixelFormat::BGR;
+    if (native_yuv) {
+        // Ask for YUYV. The driver may keep another format
+        video.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V'));
+        video.set(cv::CAP_PROP_CONVERT_RGB, 0);
+        fourcc = static_cast<int>(video.get(cv::CAP_PROP_FOURCC));
+        width = static_cast<int>(video.get(cv::CAP_PROP_FRAME_WIDTH));
+        height = static_cast<int>(video.get(cv::CAP_PROP_FRAME_HEIGHT));
+    }
+    return true;
+}
+
+void CameraFrameSource::closeSource() {
+    if (video.isOpened()) {
+        video.release();
+    }
+}
+
+bool CameraFrameSource::readFrame(cv::Mat & frame) {
+    if (!native_yuv) {
+        return video.read(frame);
+    }
+
+    // Raw data comes as one row of bytes. Give the recycled buffer
+    // that shape so reading reuses it
+    if (!frame.empty() && frame.isContinuous()) {
+        frame = frame.reshape(1, 1);
+    }
+    if (!video.read(frame)) {
+        return false;
+    }
+    return toNativeLayout(frame);
+}
+
+bool CameraFrameSource::toNativeLayout(cv::Mat & frame) {
+
+    // Backend does not support raw frames
+    if (frame.type() == CV_8UC3) {
+        pixel_format = PixelFormat::BGR;
+        return true;
+    }
+
+    size_t bytes = frame.total() * frame.elemSize();
+    size_t pixels = static_cast<size_t>(width) * height;
+    bool is_yuyv = fourcc == cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V') ||
+                   fourcc == cv::VideoWriter::fourcc('Y', 'U', 'Y', '2');
+    bool is_nv12 = fourcc == cv::VideoWriter::fourcc('N', 'V', '1', '2');
+
+    if (frame.isContinuous() && is_yuyv && bytes == pixels * 2) {
+        frame = frame.reshape(2, height);
+        pixel_format = PixelFormat::YUYV;
+        return true;
+    }
+    if (frame.isContinuous() && is_nv12 && bytes == pixels * 3 / 2) {
+        frame = frame.reshape(1, height * 3 / 2);
+        pixel_format = PixelFormat::NV12;
+        return true;
+    }
+
+    // Compressed (MJPEG) or unknown layout: decode to BGR
+    cv::Mat decoded = cv::imdecode(frame, cv::IMREAD_COLOR);
+    if (decoded.empty()) {
+        return false;
+    }
+    frame = decoded;
+    pixel_format = PixelFormat::BGR;
+    return true;
+}
+
+bool CameraFrameSource::hasMoreFrames() { return video.isOpened(); }
+
+PixelFormat CameraFrameSource::getPixelFormat() { return pixel_format; }
@@ -0,0 +1,47 @@
+#if !defined(CAMERA_FRAME_SOURCE_H)
+#define CAMERA_FRAME_SOURCE_H
+
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+namespace ml_cam {
+
+// Frames from a camera. The camera paces itself, so frames are
+// read as fast as the driver delivers them.
+// In native YUV mode the driver's YUYV or NV12 frames are not converted
+// to BGR (CAP_PROP_CONVERT_RGB off). Cameras which deliver another layout
+// still give BGR frames
+class CameraFrameSource : public FrameSource {
+   private:
+    int camera_index;
+    bool native_yuv;
+    cv::VideoCapture video;
+
+    // Native layout of the camera
+    int fourcc = 0;
+    int width = 0;
+    int height = 0;
+    PixelFormat pixel_format = PixelFormat::BGR;  // Format of the last frame
+
+    // Give a raw frame the layout of its pixel format.
+    // Return false if the frame cannot be used
+    bool toNativeLayout(cv::Mat & frame);
+
+   protected:
+    bool openSource();
+    void closeSource();
+    bool readFrame(cv::Mat & frame);
+    bool hasMoreFrames();
+    PixelFormat getPixelFormat();
+
+   public:
+    CameraFrameSource(int camera_index, bool native_yuv = false);
+    ~CameraFrameSource();
+
+    int getCameraIndex();
+};
+
+}  // namespace ml_cam
+
+#endif  // CAMERA_FRAME_SOURCE_H
@@ -0,0 +1,70 @@
+#if !defined(DETECTION_SCHEDULE_H)
+#define DETECTION_SCHEDULE_H
+
+#include <cstdint>
+#include "timer.h"
+
+namespace ml_cam {
+
+// Decide on which frames the face detector should run.
+// Between detector runs the latest detection results are reused.
+class DetectionSchedule {
+   public:
+    enum class Mode {
+        EveryNFrames,  // Run detector at most once every N captured frames
+        MaxRate        // Run detector at most X times per second
+    };
+
+   private:
+    Mode mode = Mode::EveryNFrames;
+    uint64_t every_n_frames = 1;
+    float max_rate = 0;  // Hz. 0 means no limit
+
+    bool started = false;
+    uint64_t last_sequence = 0;
+    Timer::time_point_t last_time;
+
+   public:
+    DetectionSchedule() {}
+
+    static DetectionSchedule everyNFrames(uint64_t n) {
+        DetectionSchedule schedule;
+        schedule.mode = Mode::EveryNFrames;
+        schedule.every_n_frames = n > 0 ? n : 1;
+        return schedule;
+    }
+
+    static DetectionSchedule maxRate(float hz) {
+        DetectionSchedule schedule;
+        schedule.mode = Mode::MaxRate;
+        schedule.max_rate = hz > 0 ? hz : 0;
+        return schedule;
+    }
+
+    Mode getMode() const { return mode; }
+    uint64_t getEveryNFrames() const { return every_n_frames; }
+    float getMaxRate() const { return max_rate; }
+
+    // Is the detector due for the frame with this sequence number?
+    bool isDue(uint64_t sequence, Timer::time_point_t now) const {
+        if (!started) return true;
+        if (mode == Mode::EveryNFrames) {
+            return sequence >= last_sequence + every_n_frames;
+        }
+        if (max_rate <= 0) return true;
+        return Timer::calcDiff(last_time, now) >= static_cast<Timer::time_duration_t>(1000.0 / max_rate);
+    }
+
+    // Remember that the detector was run for this frame
+    void markRun(uint64_t sequence, Timer::time_point_t now) {
+        started = true;
+        last_sequence = sequence;
+        last_time = now;
+    }
+
+    void reset() { started = false; }
+};
+
+}  // namespace ml_cam
+
+#endif  // DETECTION_SCHEDULE_H
@@ -0,0 +1,79 @@
+#include "frame_buffer_pool.h"
+
+using namespace ml_cam;
+
+FrameBufferPool::FrameBufferPool(size_t max_buffers_per_size)
+    : max_buffers_per_size(max_buffers_per_size) {}
+
+bool FrameBufferPool::isFree(const cv::Mat & buffer) {
+    return buffer.u != nullptr && CV_XADD(&buffer.u->refcount, 0) == 1;
+}
+
+cv::Mat FrameBufferPool::acquire(const cv::Size & size, int type) {
+    Key key = {size.height, size.width, type};
+
+    std::lock_guard<std::mutex> guard(mutex);
+
+    ++acquire_count;
+    if (acquire_count % TRIM_INTERVAL == 0) {
+        trimIdleSizes();
+    }
+
+    SizeEntry & entry = buffers[key];
+    entry.last_used = acquire_count;
+    std::vector<cv::Mat> & same_size = entry.buffers;
+    for (size_t i = 0; i < same_size.size(); ++i) {
+        if (isFree(same_size[i])) {
+            ++reused_count;
+            return same_size[i];
+        }
+    }
+
+    // Pool miss. Keep the new buffer for reuse unless there are already enough
+    ++allocated_count;
+    cv::Mat buffer(size, type);
+    if (same_size.size() < max_buffers_per_size) {
+        same_size.push_back(buffer);
+    }
+    return buffer;
+}
+
+cv::Mat FrameBufferPool::copy(const cv::Mat & src) {
+    cv::Mat buffer = acquire(src.size(), src.type());
+    src.copyTo(buffer);
+    return buffer;
+}
+
+void FrameBufferPool::trimIdleSizes() {
+    std::map<Key, SizeEntry>::iterator it = buffers.begin();
+    while (it != buffers.end()) {
+        if (acquire_count - it->second.last_used < MAX_IDLE_ACQUIRES) {
+            ++it;
+            continue;
+        }
+
+        std::vector<cv::Mat> & same_size = it->second.buffers;
+        for (size_t i = 0; i < same_size.size();) {
+            if (isFree(same_size[i])) {
+                same_size.erase(same_size.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+
+        if (same_size.empty()) {
+            it = buffers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FrameBufferPool::clear() {
+    std::lock_guard<std::mutex> guard(mutex);
+    buffers.clear();
+}
+
+uint64_t FrameBufferPool::getReusedCount() { return reused_count; }
+
+uint64_t FrameBufferPool::getAllocatedCount() { return allocated_count; }
@@ -0,0 +1,77 @@
+#if !defined(FRAME_BUFFER_POOL_H)
+#define FRAME_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace ml_cam {
+
+// Recycling pool of frame buffers, keyed by size and type.
+// The pool keeps a reference to every buffer it hands out. A buffer is free
+// again as soon as nobody else references it, so users simply drop their
+// cv::Mat when they are done; there is no explicit release.
+// Reusing buffers avoids allocating several MB per frame at high resolution.
+class FrameBufferPool {
+   private:
+    struct Key {
+        int rows;
+        int cols;
+        int type;
+        bool operator<(const Key & other) const {
+            if (rows != other.rows) return rows < other.rows;
+            if (cols != other.cols) return cols < other.cols;
+            return type < other.type;
+        }
+    };
+
+    struct SizeEntry {
+        std::vector<cv::Mat> buffers;
+        uint64_t last_used = 0;  // acquire_count when last acquired
+    };
+
+    std::mutex mutex;
+    std::map<Key, SizeEntry> buffers;
+    size_t max_buffers_per_size;
+    uint64_t acquire_count = 0;
+
+    // Free buffers of a size not acquired in this many acquires are dropped
+    // (e.g. after the camera resolution changed). Sizes used by other
+    // cameras sharing the pool stay, as they are acquired every frame
+    const uint64_t MAX_IDLE_ACQUIRES = 256;
+    const uint64_t TRIM_INTERVAL = 64;
+
+    std::atomic<uint64_t> reused_count{0};
+    std::atomic<uint64_t> allocated_count{0};
+
+    // Only referenced by the pool itself
+    static bool isFree(const cv::Mat & buffer);
+
+    // Drop free buffers of sizes not used recently. Caller must hold the mutex
+    void trimIdleSizes();
+
+   public:
+    explicit FrameBufferPool(size_t max_buffers_per_size = 8);
+
+    // Buffer of given size and type. Contents are undefined
+    cv::Mat acquire(const cv::Size & size, int type);
+
+    // Pooled deep copy of src
+    cv::Mat copy(const cv::Mat & src);
+
+    // Forget all buffers. Buffers still in use stay valid
+    void clear();
+
+    // Number of buffers given out without allocating (allocations avoided)
+    uint64_t getReusedCount();
+
+    // Number of buffers allocated because no free one fit (pool misses)
+    uint64_t getAllocatedCount();
+};
+
+}  // namespace ml_cam
+
+#endif  // FRAME_BUFFER_POOL_H
@@ -0,0 +1,34 @@
+#if !defined(FRAME_PACKET_H)
+#define FRAME_PACKET_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "frame_context.h"
+#include "landmark_result.h"
+#include "timer.h"
+
+namespace ml_cam {
+
+// A frame travelling through the processing pipeline
+// together with everything the stages computed for it
+struct FramePacket {
+    uint64_t sequence = 0;  // Increasing number given by the capture stage
+    Timer::time_point_t capture_time;
+    cv::Mat frame;  // BGR frame. For frames kept in YUV, it is only set by the render stage
+    std::vector<LandMarkResult> faces;
+
+    // Derived images of frame shared by detection and alignment stages.
+    // Released before the render stage draws on frame
+    std::shared_ptr<FrameContext> context;
+
+    Timer::time_duration_t face_detection_duration = 0;
+    Timer::time_duration_t face_alignment_duration = 0;
+};
+
+typedef std::shared_ptr<FramePacket> FramePacketPtr;
+
+}  // namespace ml_cam
+
+#endif  // FRAME_PACKET_H
@@ -0,0 +1,153 @@
+#include "frame_source.h"
+
+using namespace ml_cam;
+
+FrameSource::FrameSource() {}
+
+FrameSource::~FrameSource() { stopCapture(); }
+
+double FrameSource::getFrameRate() { return 0; }
+
+PixelFormat FrameSource::getPixelFormat() { return PixelFormat::BGR; }
+
+bool FrameSource::open() {
+    close();
+
+    if (!openSource()) {
+        opened = false;
+        return false;
+    }
+
+    mailbox.clear();
+    next_sequence = 0;
+    opened = true;
+    running = true;
+    capture_thread = std::thread(&FrameSource::captureLoop, this);
+
+    return true;
+}
+
+void FrameSource::close() {
+    stopCapture();
+    closeSource();
+}
+
+void FrameSource::stopCapture() {
+    running = false;
+    frame_taken.notify_all();
+    if (capture_thread.joinable()) {
+        capture_thread.join();
+    }
+    opened = false;
+
+    frame_ready.notify_all();
+}
+
+bool FrameSource::isOpened() { return opened; }
+
+void FrameSource::setBufferPool(std::shared_ptr<FrameBufferPool> buffer_pool) {
+    this->buffer_pool = buffer_pool;
+}
+
+void FrameSource::setFreeRun(bool free_run) {
+    this->free_run = free_run;
+    frame_taken.notify_all();
+}
+
+bool FrameSource::isFreeRun() { return free_run; }
+
+std::unique_ptr<CapturedFrame> FrameSource::takeFrame() {
+    std::unique_ptr<CapturedFrame> captured = mailbox.take();
+    if (captured) {
+        frame_taken.notify_one();
+    }
+    return captured;
+}
+
+std::unique_ptr<CapturedFrame> FrameSource::waitForFrame(Timer::time_duration_t timeout) {
+    std::unique_ptr<CapturedFrame> captured = takeFrame();
+    if (captured) {
+        return captured;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(frame_ready_mutex);
+        frame_ready.wait_for(lock, std::chrono::milliseconds(timeout),
+                             [this] { return !mailbox.empty() || !opened; });
+    }
+
+    return takeFrame();
+}
+
+uint64_t FrameSource::getCapturedFrameCount() { return mailbox.getPublishedCount(); }
+
+uint64_t FrameSource::getDroppedFrameCount() { return mailbox.getDroppedCount(); }
+
+void FrameSource::captureLoop() {
+    typedef std::chrono::steady_clock pace_clock_t;
+    pace_clock_t::time_point next_frame_time = pace_clock_t::now();
+
+    // Frames usually keep their size, so a buffer of the last frame's size is reused
+    cv::Size last_frame_size;
+    int last_frame_type = 0;
+
+    while (running) {
+        if (!hasMoreFrames()) {
+            break;
+        }
+
+        std::unique_ptr<CapturedFrame> captured(new CapturedFrame());
+        if (buffer_pool && !last_frame_size.empty()) {
+            captured->frame = buffer_pool->acquire(last_frame_size, last_frame_type);
+        }
+        if (!readFrame(captured->frame) || captured->frame.empty()) {
+            // Do not spin when source gives no frame
+            Timer::delay(5);
+            continue;
+        }
+
+        captured->format = getPixelFormat();
+        captured->capture_time = Timer::getCurrentTime();
+        captured->sequence = ++next_sequence;
+        last_frame_size = captured->frame.size();
+        last_frame_type = captured->frame.type();
+
+        {
+            std::lock_guard<std::mutex> guard(frame_ready_mutex);
+            mailbox.publish(std::move(captured));
+        }
+        frame_ready.notify_one();
+
+        if (free_run) {
+            // Wait until the consumer took the frame, so none is dropped.
+            // Timeout only guards against a missed notification
+            std::unique_lock<std::mutex> lock(frame_ready_mutex);
+            while (running && free_run && !mailbox.empty()) {
+                frame_taken.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            next_frame_time = pace_clock_t::now();
+            continue;
+        }
+
+        // Play the source at its frame rate
+        double frame_rate = getFrameRate();
+        if (frame_rate > 0) {
+            next_frame_time += std::chrono::duration_cast<pace_clock_t::duration>(
+                std::chrono::duration<double>(1.0 / frame_rate));
+            pace_clock_t::time_point now = pace_clock_t::now();
+            if (next_frame_time < now) {
+                // Too late. Do not try to catch up
+                next_frame_time = now;
+            } else {
+                std::this_thread::sleep_until(next_frame_time);
+            }
+        }
+    }
+
+    // Source was lost or has no more frames
+    {
+        std::lock_guard<std::mutex> guard(frame_ready_mutex);
+        opened = false;
+    }
+    frame_ready.notify_all();
+}
@@ -0,0 +1,115 @@
+#if !defined(FRAME_SOURCE_H)
+#define FRAME_SOURCE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+#include "frame_buffer_pool.h"
+#include "frame_context.h"
+#include "latest_mailbox.h"
+#include "timer.h"
+
+namespace ml_cam {
+
+// A frame read from the source with the time it was captured
+struct CapturedFrame {
+    uint64_t sequence = 0;  // Counts every frame read from the source
+    Timer::time_point_t capture_time;
+    cv::Mat frame;
+    PixelFormat format = PixelFormat::BGR;
+};
+
+// Base class of all frame sources (camera, video file, image sequence...).
+// It owns the capture thread, which keeps reading frames and publishes only
+// the newest one to a latest-frame mailbox, so consumers always get the
+// freshest frame however slow they are.
+//
+// Sources which are not paced by hardware (files, generated frames) are
+// played at their frame rate. In free-run mode they instead produce the next
+// frame as soon as the previous one was taken, so no frame is dropped and
+// the pipeline runs as fast as it can. Use it to measure throughput.
+//
+// Derived classes implement the open/read/close hooks and must call close()
+// in their destructor, so the capture thread stops before they are destroyed.
+class FrameSource {
+   private:
+    std::thread capture_thread;
+    std::atomic<bool> running{false};
+    std::atomic<bool> opened{false};
+    std::atomic<bool> free_run{false};
+
+    LatestMailbox<CapturedFrame> mailbox;
+    uint64_t next_sequence = 0;  // Used by capture thread only
+
+    // Frames are read into recycled buffers
+    std::shared_ptr<FrameBufferPool> buffer_pool;
+
+    // Used to wake up consumers waiting for a new frame,
+    // and the capture thread waiting for a frame to be taken in free-run mode
+    std::mutex frame_ready_mutex;
+    std::condition_variable frame_ready;
+    std::condition_variable frame_taken;
+
+    void captureLoop();
+    void stopCapture();
+
+   protected:
+    // Open the underlying device or file
+    virtual bool openSource() = 0;
+    virtual void closeSource() = 0;
+
+    // Read next frame. Return false if no frame could be read this time.
+    // frame may already hold a buffer of the size of the previous frame;
+    // write into it (e.g. with copyTo or VideoCapture::read) to reuse it
+    virtual bool readFrame(cv::Mat & frame) = 0;
+
+    // False when the source cannot give any more frames
+    // (camera lost, end of a file which is not looped)
+    virtual bool hasMoreFrames() = 0;
+
+    // Rate the frames are played at. 0 means the source paces itself (camera)
+    virtual double getFrameRate();
+
+    // Pixel format of the frame last read. BGR unless the source keeps
+    // frames in their native layout
+    virtual PixelFormat getPixelFormat();
+
+   public:
+    FrameSource();
+    virtual ~FrameSource();
+
+    // Open source and start capture thread
+    bool open();
+    void close();
+
+    // False after the source was lost or ran out of frames
+    bool isOpened();
+
+    // Pool to read frames into. Set it before open()
+    void setBufferPool(std::shared_ptr<FrameBufferPool> buffer_pool);
+
+    void setFreeRun(bool free_run);
+    bool isFreeRun();
+
+    // Take newest frame. Return nullptr if no new frame since last call
+    std::unique_ptr<CapturedFrame> takeFrame();
+
+    // Wait at most timeout miliseconds for a new frame.
+    // Return nullptr on timeout or when the source is closed
+    std::unique_ptr<CapturedFrame> waitForFrame(Timer::time_duration_t timeout);
+
+    // Number of frames read from the source
+    uint64_t getCapturedFrameCount();
+
+    // Number of captured frames no consumer ever took
+    uint64_t getDroppedFrameCount();
+};
+
+}  // namespace ml_cam
+
+#endif  // FRAME_SOURCE_H
@@ -0,0 +1,60 @@
+#include "image_sequence_frame_source.h"
+
+#include <algorithm>
+#include <cctype>
+
+using namespace ml_cam;
+
+ImageSequenceFrameSource::ImageSequenceFrameSource(const std::string & dir_path,
+                                                   double frame_rate, bool loop)
+    : dir_path(dir_path), frame_rate(frame_rate), loop(loop) {}
+
+ImageSequenceFrameSource::~ImageSequenceFrameSource() { close(); }
+
+bool ImageSequenceFrameSource::isImageFile(const fs::path & path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" ||
+           ext == ".webp" || ext == ".tif" || ext == ".tiff";
+}
+
+bool ImageSequenceFrameSource::openSource() {
+    image_paths.clear();
+
+    std::error_code error;
+    if (!fs::is_directory(dir_path, error)) {
+        return false;
+    }
+
+    for (const auto & entry : fs::directory_iterator(dir_path, error)) {
+        if (fs::is_regular_file(entry.path()) && isImageFile(entry.path())) {
+            image_paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(image_paths.begin(), image_paths.end());
+
+    next_image = 0;
+    finished = false;
+    return !image_paths.empty();
+}
+
+void ImageSequenceFrameSource::closeSource() {}
+
+bool ImageSequenceFrameSource::readFrame(cv::Mat & frame) {
+    if (next_image >= image_paths.size()) {
+        if (!loop) {
+            finished = true;
+            return false;
+        }
+        next_image = 0;
+    }
+
+    // Unreadable images are skipped
+    frame = cv::imread(image_paths[next_image++], cv::IMREAD_COLOR);
+    return !frame.empty();
+}
+
+bool ImageSequenceFrameSource::hasMoreFrames() { return !finished; }
+
+double ImageSequenceFrameSource::getFrameRate() { return frame_rate; }
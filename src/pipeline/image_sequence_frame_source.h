@@ -0,0 +1,43 @@
+#if !defined(IMAGE_SEQUENCE_FRAME_SOURCE_H)
+#define IMAGE_SEQUENCE_FRAME_SOURCE_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "filesystem_include.h"
+#include "frame_source.h"
+
+namespace ml_cam {
+
+// Frames from the images of a directory, in file name order,
+// played at a given frame rate.
+// When loop is set, the sequence starts again after the last image
+class ImageSequenceFrameSource : public FrameSource {
+   private:
+    std::string dir_path;
+    double frame_rate;
+    bool loop;
+    std::vector<std::string> image_paths;
+    size_t next_image = 0;  // Used by capture thread only
+    std::atomic<bool> finished{false};
+
+    static bool isImageFile(const fs::path & path);
+
+   protected:
+    bool openSource();
+    void closeSource();
+    bool readFrame(cv::Mat & frame);
+    bool hasMoreFrames();
+    double getFrameRate();
+
+   public:
+    ImageSequenceFrameSource(const std::string & dir_path, double frame_rate = 30,
+                             bool loop = true);
+    ~ImageSequenceFrameSource();
+};
+
+}  // namespace ml_cam
+
+#endif  // IMAGE_SEQUENCE_FRAME_SOURCE_H
@@ -0,0 +1,54 @@
+#if !defined(LATEST_MAILBOX_H)
+#define LATEST_MAILBOX_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace ml_cam {
+
+// Single-slot lock-free mailbox.
+// The producer always overwrites the slot with its newest item; the consumer
+// takes whatever is there. Items overwritten before being taken are counted
+// as dropped, so we know how many items the consumer never saw.
+template <typename T>
+class LatestMailbox {
+   private:
+    std::atomic<T *> slot{nullptr};
+    std::atomic<uint64_t> published_count{0};
+    std::atomic<uint64_t> dropped_count{0};
+
+   public:
+    LatestMailbox() {}
+    ~LatestMailbox() { delete slot.exchange(nullptr); }
+
+    LatestMailbox(const LatestMailbox &) = delete;
+    LatestMailbox & operator=(const LatestMailbox &) = delete;
+
+    // Put a new item into the slot, replacing (and dropping) the old one
+    void publish(std::unique_ptr<T> item) {
+        T *old_item = slot.exchange(item.release(), std::memory_order_acq_rel);
+        ++published_count;
+        if (old_item != nullptr) {
+            ++dropped_count;
+            delete old_item;
+        }
+    }
+
+    // Take the newest item. Return nullptr if nothing new was published
+    std::unique_ptr<T> take() {
+        return std::unique_ptr<T>(slot.exchange(nullptr, std::memory_order_acq_rel));
+    }
+
+    // Drop the item in the slot without counting it
+    void clear() { delete slot.exchange(nullptr); }
+
+    bool empty() const { return slot.load(std::memory_order_acquire) == nullptr; }
+
+    uint64_t getPublishedCount() const { return published_count; }
+    uint64_t getDroppedCount() const { return dropped_count; }
+};
+
+}  // namespace ml_cam
+
+#endif  // LATEST_MAILBOX_H
@@ -0,0 +1,80 @@
+#include "motion_gate.h"
+
+#include <algorithm>
+
+using namespace ml_cam;
+
+MotionGate::MotionGate(int pyramid_level, int tiles_x, int tiles_y, float threshold)
+    // Level 0 can be a view of a recycled frame buffer, which must not be kept as reference
+    : pyramid_level(std::max(1, pyramid_level)),
+      tiles_x(std::max(1, tiles_x)),
+      tiles_y(std::max(1, tiles_y)),
+      threshold(threshold) {}
+
+void MotionGate::setThreshold(float threshold) { this->threshold = threshold; }
+
+float MotionGate::getThreshold() const { return threshold; }
+
+void MotionGate::setReference(FrameContext & context) {
+    reference = context.getPyramidLevel(pyramid_level);
+}
+
+bool MotionGate::hasReference() const { return !reference.empty(); }
+
+void MotionGate::reset() { reference.release(); }
+
+MotionGate::Motion MotionGate::compare(FrameContext & context) {
+    Motion motion;
+    motion.tiles = tiles_x * tiles_y;
+
+    cv::Size frame_size = context.getSize();
+    cv::Mat thumbnail = context.getPyramidLevel(pyramid_level);
+    if (reference.empty() || reference.size() != thumbnail.size()) {
+        motion.changed_tiles = motion.tiles;
+        motion.regions.push_back(cv::Rect(cv::Point(0, 0), frame_size));
+        return motion;
+    }
+
+    cv::absdiff(thumbnail, reference, diff);
+
+    double scale_x = static_cast<double>(frame_size.width) / thumbnail.cols;
+    double scale_y = static_cast<double>(frame_size.height) / thumbnail.rows;
+    std::vector<cv::Rect> changed;
+    for (int ty = 0; ty < tiles_y; ++ty) {
+        for (int tx = 0; tx < tiles_x; ++tx) {
+            int x0 = tx * thumbnail.cols / tiles_x;
+            int x1 = (tx + 1) * thumbnail.cols / tiles_x;
+            int y0 = ty * thumbnail.rows / tiles_y;
+            int y1 = (ty + 1) * thumbnail.rows / tiles_y;
+            if (x1 <= x0 || y1 <= y0) {
+                continue;
+            }
+
+            if (cv::mean(diff(cv::Rect(x0, y0, x1 - x0, y1 - y0)))[0] > threshold) {
+                ++motion.changed_tiles;
+                changed.push_back(cv::Rect(cv::Point(cvRound(x0 * scale_x), cvRound(y0 * scale_y)),
+                                           cv::Point(cvRound(x1 * scale_x), cvRound(y1 * scale_y))));
+            }
+        }
+    }
+
+    // Merge touching tiles (there are only a few, so repeat until nothing merges)
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < changed.size() && !merged; ++i) {
+            cv::Rect grown(changed[i].x - 1, changed[i].y - 1, changed[i].width + 2, changed[i].height + 2);
+            for (size_t j = i + 1; j < changed.size(); ++j) {
+                if ((grown & changed[j]).area() > 0) {
+                    changed[i] |= changed[j];
+                    changed.erase(changed.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    motion.regions = changed;
+
+    return motion;
+}
@@ -0,0 +1,56 @@
+#if !defined(MOTION_GATE_H)
+#define MOTION_GATE_H
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "frame_context.h"
+
+namespace ml_cam {
+
+// Cheap change detector used to skip face detection on static scenes.
+// Frames are compared with a reference frame (the last frame the detector
+// ran on) by the mean absolute difference of a small gray thumbnail,
+// in a grid of tiles.
+class MotionGate {
+   public:
+    struct Motion {
+        int changed_tiles = 0;
+        int tiles = 0;
+        // Changed tiles in frame coordinates. Touching tiles are merged,
+        // so a face on a tile border is inside one region
+        std::vector<cv::Rect> regions;
+
+        bool isStatic() const { return changed_tiles == 0; }
+    };
+
+   private:
+    int pyramid_level;
+    int tiles_x;
+    int tiles_y;
+    float threshold;
+
+    cv::Mat reference;  // Thumbnail of the reference frame. Shared with its context, never modified
+    cv::Mat diff;
+
+   public:
+    // The thumbnail is the gray frame downscaled by 2^pyramid_level (at least 1).
+    // A tile changed when its mean absolute difference is above threshold (gray levels)
+    MotionGate(int pyramid_level = 3, int tiles_x = 4, int tiles_y = 4, float threshold = 4.0f);
+
+    void setThreshold(float threshold);
+    float getThreshold() const;
+
+    // Compare frames with this frame from now on
+    void setReference(FrameContext & context);
+    bool hasReference() const;
+    void reset();
+
+    // Changed tiles since the reference frame. Every tile changed when
+    // there is no reference or the frame size is different
+    Motion compare(FrameContext & context);
+};
+
+}  // namespace ml_cam
+
+#endif  // MOTION_GATE_H
@@ -0,0 +1,157 @@
+#include "pre_roll_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace ml_cam;
+
+cv::Mat PreRollBuffer::Frame::decode() const {
+    if (!jpeg.empty()) {
+        return cv::imdecode(jpeg, cv::IMREAD_COLOR);
+    }
+    return raw;
+}
+
+PreRollBuffer::PreRollBuffer(double seconds, double max_fps, bool compress, int jpeg_quality)
+    : slots(std::max<size_t>(1, static_cast<size_t>(std::ceil(seconds * max_fps)))),
+      duration(static_cast<Timer::time_duration_t>(seconds * 1000)),
+      compress(compress),
+      jpeg_quality(jpeg_quality),
+      frame_queue(4, DropPolicy::DropNewest) {
+    worker = std::thread(&PreRollBuffer::workerLoop, this);
+}
+
+PreRollBuffer::~PreRollBuffer() {
+    frame_queue.close();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void PreRollBuffer::addFrame(const cv::Mat & frame) {
+    if (frame.empty()) {
+        return;
+    }
+    frame_queue.push(frame);
+}
+
+void PreRollBuffer::workerLoop() {
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, jpeg_quality};
+
+    cv::Mat frame;
+    while (frame_queue.pop(frame)) {
+        // Encode into the scratch slot without holding the lock.
+        // The vector / Mat keep their memory from the slot they were swapped with
+        scratch.time = Timer::getCurrentTime();
+        if (compress) {
+            cv::imencode(".jpg", frame, scratch.jpeg, params);
+        } else {
+            frame.copyTo(scratch.raw);
+        }
+        frame.release();
+
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            std::swap(slots[next_slot], scratch);
+            next_slot = (next_slot + 1) % slots.size();
+            filled_slots = std::min(filled_slots + 1, slots.size());
+        }
+    }
+}
+
+std::vector<PreRollBuffer::Frame> PreRollBuffer::getFrames() {
+    std::vector<Frame> frames;
+    Timer::time_point_t now = Timer::getCurrentTime();
+
+    std::lock_guard<std::mutex> guard(mutex);
+    frames.reserve(filled_slots);
+    size_t first_slot = (next_slot + slots.size() - filled_slots) % slots.size();
+    for (size_t i = 0; i < filled_slots; ++i) {
+        const Frame & slot = slots[(first_slot + i) % slots.size()];
+        if (Timer::calcDiff(slot.time, now) > duration) {
+            continue;
+        }
+        frames.push_back(slot);
+        // Raw slots are overwritten in place, so take a deep copy
+        if (!slot.raw.empty()) {
+            frames.back().raw = slot.raw.clone();
+        }
+    }
+    return frames;
+}
+
+void PreRollBuffer::clear() {
+    std::lock_guard<std::mutex> guard(mutex);
+    filled_slots = 0;
+}
+
+bool PreRollBuffer::writeVideo(const std::vector<Frame> & frames, const fs::path & path, int fourcc) {
+    if (frames.empty()) {
+        return false;
+    }
+
+    // Play at the rate frames were stored
+    double fps = 30;
+    Timer::time_duration_t length = Timer::calcDiff(frames.front().time, frames.back().time);
+    if (frames.size() > 1 && length > 0) {
+        fps = 1000.0 * (frames.size() - 1) / length;
+    }
+
+    cv::VideoWriter writer;
+    cv::Size frame_size;
+    cv::Mat image, resized;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        image = frames[i].decode();
+        if (image.empty()) {
+            continue;
+        }
+        if (!writer.isOpened()) {
+            if (!writer.open(path.string(), fourcc, fps, image.size(), true)) {
+                std::cerr << "Could not open video file: " << path << std::endl;
+                return false;
+            }
+            frame_size = image.size();
+        }
+        if (image.size() != frame_size) {
+            cv::resize(image, resized, frame_size);
+            writer.write(resized);
+        } else {
+            writer.write(image);
+        }
+    }
+    return writer.isOpened();
+}
+
+bool PreRollBuffer::writeBurst(const std::vector<Frame> & frames, const fs::path & directory) {
+    if (frames.empty()) {
+        return false;
+    }
+
+    fs::create_directories(directory);
+    if (!fs::is_directory(directory)) {
+        std::cerr << "Could not create directory: " << directory << std::endl;
+        return false;
+    }
+
+    bool success = true;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        std::stringstream filename;
+        filename << std::setw(4) << std::setfill('0') << i;
+
+        if (!frames[i].jpeg.empty()) {
+            // Already encoded
+            fs::path filepath = directory / (filename.str() + ".jpg");
+            std::ofstream file(filepath.string(), std::ios::binary);
+            file.write(reinterpret_cast<const char *>(frames[i].jpeg.data()), frames[i].jpeg.size());
+            success = success && file.good();
+        } else {
+            fs::path filepath = directory / (filename.str() + ".png");
+            success = cv::imwrite(filepath.string(), frames[i].raw) && success;
+        }
+    }
+    return success;
+}
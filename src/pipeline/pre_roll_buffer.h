@@ -0,0 +1,76 @@
+#if !defined(PRE_ROLL_BUFFER_H)
+#define PRE_ROLL_BUFFER_H
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "bounded_queue.h"
+#include "filesystem_include.h"
+#include "timer.h"
+
+namespace ml_cam {
+
+// Keep the last seconds of frames in memory, so they can be saved after
+// the moment happened ("instant replay").
+// Frames are stored in a ring of fixed slots, compressed to JPEG (or copied
+// raw) on a background worker. Once every slot was used, slots reuse their
+// buffers and the ring does not allocate anymore.
+class PreRollBuffer {
+   public:
+    // One stored frame
+    struct Frame {
+        std::vector<uchar> jpeg;  // JPEG data when compression is used
+        cv::Mat raw;              // Frame copy when compression is not used
+        Timer::time_point_t time;
+
+        cv::Mat decode() const;
+    };
+
+   private:
+    std::vector<Frame> slots;
+    size_t next_slot = 0;  // Slot to overwrite next
+    size_t filled_slots = 0;
+    Timer::time_duration_t duration;
+
+    bool compress;
+    int jpeg_quality;
+
+    std::mutex mutex;  // Guards the ring
+
+    // Frames waiting for the worker. The worker is always behind by at most
+    // a few frames. Newest frames are dropped if it cannot keep up
+    BoundedQueue<cv::Mat> frame_queue;
+    std::thread worker;
+    Frame scratch;  // Used by worker only. Swapped with the slot it replaces
+
+    void workerLoop();
+
+   public:
+    // Keep frames of the last seconds. Memory is reserved for
+    // seconds * max_fps frames
+    PreRollBuffer(double seconds = 5, double max_fps = 30, bool compress = true, int jpeg_quality = 90);
+    ~PreRollBuffer();
+
+    // Queue a frame to be stored. The frame is not copied here, so it must
+    // not be modified after being added
+    void addFrame(const cv::Mat & frame);
+
+    // Copy of the stored frames of the last seconds, oldest first
+    std::vector<Frame> getFrames();
+
+    // Forget all stored frames (buffers are kept)
+    void clear();
+
+    // Write frames as a video. The frame rate is computed from the frame times
+    static bool writeVideo(const std::vector<Frame> & frames, const fs::path & path, int fourcc);
+
+    // Write frames as numbered images into a directory (created if needed)
+    static bool writeBurst(const std::vector<Frame> & frames, const fs::path & directory);
+};
+
+}  // namespace ml_cam
+
+#endif  // PRE_ROLL_BUFFER_H
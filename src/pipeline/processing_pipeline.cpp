@@ -0,0 +1,564 @@
+#include "processing_pipeline.h"
+
+using namespace ml_cam;
+
+ProcessingPipeline::ProcessingPipeline(size_t queue_capacity, DropPolicy drop_policy)
+    : buffer_pool(std::make_shared<FrameBufferPool>()),
+      alignment_queue(queue_capacity, drop_policy),
+      render_queue(queue_capacity, drop_policy),
+      finished_queue(queue_capacity, DropPolicy::DropOldest) {
+    async_face_detector.setBufferPool(buffer_pool);
+}
+
+ProcessingPipeline::~ProcessingPipeline() { stop(); }
+
+bool ProcessingPipeline::start(int camera_index, bool native_yuv) {
+    return start(std::make_shared<CameraFrameSource>(camera_index, native_yuv));
+}
+
+bool ProcessingPipeline::start(std::shared_ptr<FrameSource> source) {
+    stop();
+
+    if (!source) {
+        return false;
+    }
+    source->setBufferPool(buffer_pool);
+    if (!source->open()) {
+        return false;
+    }
+    frame_source = source;
+
+    alignment_queue.reopen();
+    render_queue.reopen();
+    finished_queue.reopen();
+    last_rendered_sequence = 0;
+    rendered_frame_count = 0;
+    last_face_detector = nullptr;
+    last_face_landmark_detector = nullptr;
+
+    // Sequence numbers and times start over with the new source
+    {
+        std::lock_guard<std::mutex> guard(settings_mutex);
+        detection_schedule.reset();
+        full_scan_schedule.reset();
+    }
+
+    running = true;
+    detection_thread = std::thread(&ProcessingPipeline::detectionLoop, this);
+    alignment_thread = std::thread(&ProcessingPipeline::alignmentLoop, this);
+    render_thread = std::thread(&ProcessingPipeline::renderLoop, this);
+
+    return true;
+}
+
+void ProcessingPipeline::stop() {
+    running = false;
+
+    // Wake up every stage waiting on a queue
+    alignment_queue.close();
+    render_queue.close();
+    finished_queue.close();
+
+    if (detection_thread.joinable()) detection_thread.join();
+    if (alignment_thread.joinable()) alignment_thread.join();
+    if (render_thread.joinable()) render_thread.join();
+
+    if (frame_source) {
+        frame_source->close();
+    }
+}
+
+bool ProcessingPipeline::isRunning() { return running; }
+
+bool ProcessingPipeline::isSourceOpened() { return frame_source && frame_source->isOpened(); }
+
+void ProcessingPipeline::setDropPolicy(DropPolicy drop_policy) {
+    alignment_queue.setDropPolicy(drop_policy);
+    render_queue.setDropPolicy(drop_policy);
+}
+
+void ProcessingPipeline::setFlip(bool flip) { flip_frame = flip; }
+
+void ProcessingPipeline::setFaceDetector(std::shared_ptr<FaceDetector> detector) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    face_detector = detector;
+}
+
+void ProcessingPipeline::setFaceLandmarkDetector(std::shared_ptr<FaceLandmarkDetector> detector) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    face_landmark_detector = detector;
+}
+
+void ProcessingPipeline::setImageEffects(const std::vector<std::shared_ptr<ImageEffect>> & effects) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    image_effects = effects;
+}
+
+void ProcessingPipeline::setAsyncDetection(bool async_detection) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    this->async_detection = async_detection;
+}
+
+void ProcessingPipeline::setFaceTracking(bool face_tracking) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    this->face_tracking = face_tracking;
+}
+
+bool ProcessingPipeline::isFaceTracking() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return face_tracking;
+}
+
+void ProcessingPipeline::setDetectionSchedule(const DetectionSchedule & schedule) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    detection_schedule = schedule;
+}
+
+void ProcessingPipeline::setROIDetection(bool roi_detection, const DetectionSchedule & full_scan_schedule) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    this->roi_detection = roi_detection;
+    this->full_scan_schedule = full_scan_schedule;
+}
+
+bool ProcessingPipeline::isROIDetection() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return roi_detection;
+}
+
+bool ProcessingPipeline::isFullScanDue(uint64_t sequence, Timer::time_point_t now) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return full_scan_schedule.isDue(sequence, now);
+}
+
+void ProcessingPipeline::markFullScanRun(uint64_t sequence, Timer::time_point_t now) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    full_scan_schedule.markRun(sequence, now);
+}
+
+void ProcessingPipeline::setMotionGating(bool motion_gating, float threshold) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    this->motion_gating = motion_gating;
+    this->motion_threshold = threshold;
+}
+
+bool ProcessingPipeline::isMotionGating(float & threshold) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    threshold = motion_threshold;
+    return motion_gating;
+}
+
+bool ProcessingPipeline::isAsyncDetection() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return async_detection;
+}
+
+bool ProcessingPipeline::isDetectionDue(uint64_t sequence, Timer::time_point_t now) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return detection_schedule.isDue(sequence, now);
+}
+
+void ProcessingPipeline::markDetectionRun(uint64_t sequence, Timer::time_point_t now) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    detection_schedule.markRun(sequence, now);
+}
+
+void ProcessingPipeline::setFrameReadyCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    frame_ready_callback = callback;
+}
+
+void ProcessingPipeline::setCameraLostCallback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    camera_lost_callback = callback;
+}
+
+void ProcessingPipeline::setVideoRecorder(std::shared_ptr<VideoRecorder> recorder) {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    video_recorder = recorder;
+}
+
+std::shared_ptr<VideoRecorder> ProcessingPipeline::getVideoRecorder() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return video_recorder;
+}
+
+std::function<void()> ProcessingPipeline::getFrameReadyCallback() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return frame_ready_callback;
+}
+
+std::function<void()> ProcessingPipeline::getCameraLostCallback() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return camera_lost_callback;
+}
+
+std::shared_ptr<FaceDetector> ProcessingPipeline::getFaceDetector() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return face_detector;
+}
+
+std::shared_ptr<FaceLandmarkDetector> ProcessingPipeline::getFaceLandmarkDetector() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return face_landmark_detector;
+}
+
+std::vector<std::shared_ptr<ImageEffect>> ProcessingPipeline::getImageEffects() {
+    std::lock_guard<std::mutex> guard(settings_mutex);
+    return image_effects;
+}
+
+bool ProcessingPipeline::waitForFinishedFrame(FramePacketPtr & packet, Timer::time_duration_t timeout) {
+    return finished_queue.pop(packet, timeout);
+}
+
+bool ProcessingPipeline::takeLatestFinishedFrame(FramePacketPtr & packet) {
+    bool found = false;
+    FramePacketPtr next;
+    while (finished_queue.pop(next, 0)) {
+        packet = next;
+        found = true;
+    }
+    return found;
+}
+
+std::shared_ptr<FrameBufferPool> ProcessingPipeline::getBufferPool() { return buffer_pool; }
+
+uint64_t ProcessingPipeline::getRenderedFrameCount() { return rendered_frame_count; }
+
+uint64_t ProcessingPipeline::getCaptureDroppedFrameCount() {
+    return frame_source ? frame_source->getDroppedFrameCount() : 0;
+}
+
+uint64_t ProcessingPipeline::getDroppedFrameCount() {
+    return getCaptureDroppedFrameCount() + alignment_queue.getDroppedCount() +
+           render_queue.getDroppedCount();
+}
+
+float ProcessingPipeline::getDetectionSkipRatio() {
+    uint64_t gated = gated_detection_count;
+    return gated == 0 ? 0 : static_cast<float>(skipped_detection_count) / gated;
+}
+
+float ProcessingPipeline::getPartialDetectionRatio() {
+    uint64_t gated = gated_detection_count;
+    return gated == 0 ? 0 : static_cast<float>(partial_detection_count) / gated;
+}
+
+// *** Stage 1: Capture frames from camera (or another frame source)
+// This stage is FrameSource's capture thread.
+
+// *** Stage 2: Detect faces on the newest captured frame
+void ProcessingPipeline::detectionLoop() {
+    while (running) {
+        std::unique_ptr<CapturedFrame> captured = frame_source->waitForFrame(20);
+        if (!captured) {
+            if (!frame_source->isOpened()) {
+                std::function<void()> callback = getCameraLostCallback();
+                if (callback) {
+                    callback();
+                }
+                break;
+            }
+            continue;
+        }
+
+        FramePacketPtr packet = std::make_shared<FramePacket>();
+        packet->sequence = captured->sequence;
+        packet->capture_time = captured->capture_time;
+        cv::Mat raw = captured->frame;
+        PixelFormat format = captured->format;
+
+        if (format == PixelFormat::BGR) {
+            // Flip frame
+            if (flip_frame) {
+                cv::flip(raw, raw, 1);
+            }
+            packet->frame = raw;
+            packet->context = std::make_shared<FrameContext>(packet->frame);
+        } else {
+            // YUV frames cannot be flipped in place
+            if (flip_frame) {
+                cv::Mat flipped = buffer_pool->acquire(raw.size(), raw.type());
+                flipFrame(raw, flipped, format);
+                raw = flipped;
+            }
+
+            // BGR image is converted into a recycled buffer the first time
+            // a stage needs it. packet->frame is set by render stage
+            cv::Size size(raw.cols, format == PixelFormat::NV12 ? raw.rows * 2 / 3 : raw.rows);
+            packet->context = std::make_shared<FrameContext>(
+                raw, format, buffer_pool->acquire(size, CV_8UC3));
+        }
+
+        std::shared_ptr<FaceDetector> detector = getFaceDetector();
+
+        // Results of the old detector are no longer valid
+        if (detector != last_face_detector) {
+            async_face_detector.clearResult();
+            face_tracker.reset();
+            track_id_assigner.reset();
+            last_detected_faces.clear();
+            last_detection_sequence = 0;
+            last_detection_duration = 0;
+            detection_run_count = 0;
+            last_frame_faces.clear();
+            motion_gate.reset();
+            last_face_detector = detector;
+        }
+
+        bool tracking = isFaceTracking();
+        if (!tracking && face_tracker.isTracking()) {
+            face_tracker.reset();
+        }
+
+        if (detector) {
+
+            // Run detector on schedule, or earlier when the tracker lost faces
+            Timer::time_point_t now = Timer::getCurrentTime();
+            bool faces_lost = tracking && face_tracker.needsRedetection();
+            bool detection_due = isDetectionDue(packet->sequence, now) || faces_lost;
+
+            // ROI detection searches around the faces of last frame, unless
+            // the whole frame is due to be scanned for new faces
+            DetectionScope scope;
+            scope.run_count = detection_run_count;
+            bool full_scan = true;
+            if (detection_due && isROIDetection() && !faces_lost && !last_frame_faces.empty() &&
+                !isFullScanDue(packet->sequence, now)) {
+                scope.known_faces = last_frame_faces;
+                full_scan = false;
+            }
+
+            // Motion gating: no new face can appear and no face can move
+            // where the frame did not change since the last detection
+            float motion_threshold;
+            bool motion_gating = isMotionGating(motion_threshold);
+            if (detection_due && motion_gating && !faces_lost && last_detection_sequence != 0 &&
+                motion_gate.hasReference()) {
+                motion_gate.setThreshold(motion_threshold);
+                MotionGate::Motion motion = motion_gate.compare(*packet->context);
+                ++gated_detection_count;
+                if (motion.isStatic()) {
+                    // Stays due, so the next frame is checked again
+                    detection_due = false;
+                    ++skipped_detection_count;
+                } else if (motion.changed_tiles <= motion.tiles * MAX_PARTIAL_MOTION_RATIO) {
+                    scope.changed_regions = motion.regions;
+                    full_scan = false;
+                    ++partial_detection_count;
+                }
+            }
+
+            if (detection_due) {
+                scope.previous_faces = last_detected_faces;
+            }
+
+            if (isAsyncDetection()) {
+
+                // Start a new detection if it is due and the worker is free
+                if (detection_due &&
+                    async_face_detector.submit(detector, raw, packet->sequence, format, scope)) {
+                    ++detection_run_count;
+                    markDetectionRun(packet->sequence, now);
+                    if (full_scan) {
+                        markFullScanRun(packet->sequence, now);
+                    }
+                    if (motion_gating) {
+                        motion_gate.setReference(*packet->context);
+                    }
+                }
+
+                // Take a new result when the worker finished one
+                DetectionResult result;
+                if (async_face_detector.getLatestResult(result) &&
+                    result.sequence != last_detection_sequence) {
+                    last_detected_faces = result.faces;
+                    last_detection_sequence = result.sequence;
+                    last_detection_duration = result.duration;
+
+                    // Result belongs to an older frame. Tracker moves it to current frame
+                    if (tracking) {
+                        face_tracker.init(*result.context, result.faces);
+                    }
+                }
+
+            } else if (detection_due) {
+                Timer::time_point_t start_time = Timer::getCurrentTime();
+                last_detected_faces = detector->detectInScope(*packet->context, scope);
+                last_detection_duration = Timer::calcTimePassed(start_time);
+                last_detection_sequence = packet->sequence;
+                ++detection_run_count;
+                markDetectionRun(packet->sequence, now);
+                if (full_scan) {
+                    markFullScanRun(packet->sequence, now);
+                }
+                if (motion_gating) {
+                    motion_gate.setReference(*packet->context);
+                }
+
+                if (tracking) {
+                    face_tracker.init(*packet->context, last_detected_faces);
+                }
+            }
+
+            // Frames without a fresh detection use tracked faces,
+            // or the latest detection result when tracking is off
+            if (tracking && face_tracker.isTracking() && last_detection_sequence != packet->sequence) {
+                packet->faces = face_tracker.track(*packet->context);
+            } else {
+                packet->faces = last_detected_faces;
+            }
+            packet->face_detection_duration = last_detection_duration;
+
+            // Give faces stable IDs so later stages can keep per-face state
+            track_id_assigner.assign(packet->faces);
+
+            last_frame_faces.clear();
+            for (size_t i = 0; i < packet->faces.size(); ++i) {
+                last_frame_faces.push_back(packet->faces[i].getFaceRect());
+            }
+        }
+        alignment_queue.push(packet);
+    }
+}
+
+// *** Stage 3: Detect face landmarks
+void ProcessingPipeline::alignmentLoop() {
+    FramePacketPtr packet;
+    while (alignment_queue.pop(packet)) {
+        std::shared_ptr<FaceLandmarkDetector> detector = getFaceLandmarkDetector();
+
+        // Landmarks of the old detector are no longer valid
+        if (detector != last_face_landmark_detector) {
+            last_aligned_faces.clear();
+            last_face_landmark_detector = detector;
+        }
+
+        if (detector && !packet->faces.empty()) {
+            Timer::time_point_t start_time = Timer::getCurrentTime();
+            alignFaces(detector, *packet->context, packet->faces);
+            packet->face_alignment_duration = Timer::calcTimePassed(start_time);
+        }
+        render_queue.push(packet);
+    }
+}
+
+void ProcessingPipeline::alignFaces(std::shared_ptr<FaceLandmarkDetector> detector,
+                                    FrameContext & context, std::vector<LandMarkResult> & faces) {
+
+    // Faces which (almost) did not move since last frame reuse their previous
+    // landmarks, shifted with the face box. Others are fitted again
+    std::vector<int> reused_frames(faces.size(), 0);
+    std::vector<LandMarkResult> faces_to_fit;
+    std::vector<size_t> faces_to_fit_idx;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        std::map<int, AlignedFace>::iterator last = last_aligned_faces.find(faces[i].getTrackId());
+        if (last != last_aligned_faces.end() &&
+            last->second.reused_frames < MAX_LANDMARK_REUSE_FRAMES &&
+            last->second.face.haveLandmark()) {
+
+            cv::Rect old_rect = last->second.face.getFaceRect();
+            cv::Rect new_rect = faces[i].getFaceRect();
+            cv::Point shift = new_rect.tl() - old_rect.tl();
+            if (std::abs(shift.x) <= MAX_LANDMARK_REUSE_SHIFT &&
+                std::abs(shift.y) <= MAX_LANDMARK_REUSE_SHIFT &&
+                std::abs(new_rect.width - old_rect.width) <= MAX_LANDMARK_REUSE_SHIFT &&
+                std::abs(new_rect.height - old_rect.height) <= MAX_LANDMARK_REUSE_SHIFT) {
+
+                std::vector<cv::Point2f> landmark = last->second.face.getFaceLandmark();
+                for (size_t j = 0; j < landmark.size(); ++j) {
+                    landmark[j] += cv::Point2f(shift);
+                }
+                faces[i].setFaceLandmark(landmark);
+                reused_frames[i] = last->second.reused_frames + 1;
+                continue;
+            }
+        }
+
+        faces_to_fit.push_back(faces[i]);
+        faces_to_fit_idx.push_back(i);
+    }
+
+    if (!faces_to_fit.empty()) {
+        detector->detect(context, faces_to_fit);
+        for (size_t i = 0; i < faces_to_fit.size(); ++i) {
+            faces[faces_to_fit_idx[i]] = faces_to_fit[i];
+        }
+    }
+
+    // Remember landmarks of current faces
+    last_aligned_faces.clear();
+    for (size_t i = 0; i < faces.size(); ++i) {
+        if (faces[i].getTrackId() >= 0) {
+            last_aligned_faces[faces[i].getTrackId()] = {faces[i], reused_frames[i]};
+        }
+    }
+}
+
+// *** Stage 4: Apply effects / filters
+void ProcessingPipeline::renderLoop() {
+    FramePacketPtr packet;
+    while (render_queue.pop(packet)) {
+
+        // Never output a frame older than one we already rendered
+        if (packet->sequence <= last_rendered_sequence) {
+            continue;
+        }
+        last_rendered_sequence = packet->sequence;
+
+        // Frames kept in YUV get their BGR image now, unless a stage already converted it
+        if (packet->frame.empty() && packet->context) {
+            packet->frame = packet->context->getImage();
+        }
+
+        // Effects draw on the frame, so its derived images are no longer valid
+        packet->context.reset();
+
+        std::vector<LandMarkResult> & faces = packet->faces;
+
+        // Sort faces ascending by size  => Draw face filters for smaller faces behind those for bigger faces
+        std::sort(std::begin(faces), std::end(faces),
+                [] (const auto& lhs, const auto& rhs) {
+            return lhs.getFaceRect().area() < rhs.getFaceRect().area();
+        });
+
+        std::shared_ptr<VideoRecorder> recorder = getVideoRecorder();
+
+        std::vector<std::shared_ptr<ImageEffect>> effects = getImageEffects();
+        for (size_t i = 0; i < effects.size(); ++i) {
+
+            // Output FPS in debug
+            std::shared_ptr<EffectDebugInfo> debug_info = std::dynamic_pointer_cast<EffectDebugInfo>(effects[i]);
+            if (debug_info) {
+                float detection_fps = packet->face_detection_duration == 0 ? 0 : 1000.0 / packet->face_detection_duration;
+                float alignment_fps = packet->face_alignment_duration == 0 ? 0 : 1000.0 / packet->face_alignment_duration;
+                debug_info->outputFPS(detection_fps, alignment_fps);
+                debug_info->outputDroppedFrames(getCaptureDroppedFrameCount(), getDroppedFrameCount());
+                debug_info->outputBufferPool(buffer_pool->getReusedCount(), buffer_pool->getAllocatedCount());
+                if (recorder) {
+                    debug_info->outputRecording(recorder->isRecording(), recorder->getQueueDepth(),
+                                                recorder->getDroppedFrameCount());
+                }
+                if (gated_detection_count > 0) {
+                    debug_info->outputMotionGating(getDetectionSkipRatio(), getPartialDetectionRatio());
+                }
+            }
+
+            effects[i]->apply(packet->frame, faces);
+        }
+
+        // Frame is finished and not drawn on anymore, so the recorder
+        // can keep a reference instead of a copy
+        if (recorder) {
+            recorder->addFrame(packet->frame);
+        }
+
+        finished_queue.push(packet);
+        ++rendered_frame_count;
+
+        std::function<void()> callback = getFrameReadyCallback();
+        if (callback) {
+            callback();
+        }
+    }
+}
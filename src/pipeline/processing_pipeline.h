@@ -0,0 +1,227 @@
+#if !defined(PROCESSING_PIPELINE_H)
+#define PROCESSING_PIPELINE_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "async_face_detector.h"
+#include "bounded_queue.h"
+#include "detection_schedule.h"
+#include "frame_buffer_pool.h"
+#include "frame_packet.h"
+#include "motion_gate.h"
+#include "camera_frame_source.h"
+#include "frame_source.h"
+#include "face_detector.h"
+#include "face_landmark_detector.h"
+#include "face_tracker.h"
+#include "track_id_assigner.h"
+#include "image_effect.h"
+#include "effect_debug_info.h"
+#include "timer.h"
+#include "video_recorder.h"
+
+namespace ml_cam {
+
+// Multi-stage processing pipeline:
+//     capture -> face detection -> face alignment -> render (effects)
+// Every stage runs on its own thread. The capture thread (FrameSource) hands
+// only its newest frame to the detection stage. The other stages are connected
+// by bounded queues, so a slow stage only makes the stages before it drop
+// frames (according to the drop policy) instead of slowing the whole
+// application down.
+// The GUI thread only takes finished frames from the pipeline to display.
+class ProcessingPipeline {
+   private:
+    std::shared_ptr<FrameSource> frame_source;
+
+    // Recycled frame buffers for captured frames and frame copies
+    std::shared_ptr<FrameBufferPool> buffer_pool;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> flip_frame{true};
+
+    uint64_t last_rendered_sequence = 0;  // Used by render thread only
+    std::atomic<uint64_t> rendered_frame_count{0};
+
+    // Queues between stages
+    BoundedQueue<FramePacketPtr> alignment_queue;
+    BoundedQueue<FramePacketPtr> render_queue;
+    BoundedQueue<FramePacketPtr> finished_queue;
+
+    // Settings changed from GUI thread
+    std::mutex settings_mutex;
+    std::shared_ptr<FaceDetector> face_detector;
+    std::shared_ptr<FaceLandmarkDetector> face_landmark_detector;
+    std::vector<std::shared_ptr<ImageEffect>> image_effects;
+    std::function<void()> frame_ready_callback;
+    std::function<void()> camera_lost_callback;
+    std::shared_ptr<VideoRecorder> video_recorder;
+    bool async_detection = false;
+    bool face_tracking = false;
+    DetectionSchedule detection_schedule;
+    bool roi_detection = false;
+    DetectionSchedule full_scan_schedule;
+    bool motion_gating = false;
+    float motion_threshold = 4.0f;
+
+    // Asynchronous detection: detector runs on its own worker,
+    // other frames reuse the latest detection result
+    AsyncFaceDetector async_face_detector;
+
+    // Used by detection thread only
+    std::shared_ptr<FaceDetector> last_face_detector;
+    std::vector<LandMarkResult> last_detected_faces;
+    uint64_t last_detection_sequence = 0;
+    uint64_t detection_run_count = 0;  // Detector runs since the detector was set
+    Timer::time_duration_t last_detection_duration = 0;
+    std::vector<cv::Rect> last_frame_faces;  // Face boxes of the previous frame, searched around in ROI detection
+    MotionGate motion_gate;  // Reference is the last frame the detector ran on
+
+    // Detector runs considered by motion gating, and how many of them were
+    // skipped (static scene) or limited to changed regions
+    std::atomic<uint64_t> gated_detection_count{0};
+    std::atomic<uint64_t> skipped_detection_count{0};
+    std::atomic<uint64_t> partial_detection_count{0};
+
+    // Moves faces forward on frames the detector did not run on
+    FaceTracker face_tracker;
+    TrackIdAssigner track_id_assigner;
+
+    // Landmarks of each face (by track ID) from last frame. Used by alignment thread only
+    struct AlignedFace {
+        LandMarkResult face;
+        int reused_frames;  // Number of frames in a row these landmarks were reused
+    };
+    std::map<int, AlignedFace> last_aligned_faces;
+    std::shared_ptr<FaceLandmarkDetector> last_face_landmark_detector;
+
+    // Reuse landmarks of a face when its box moved at most this number of pixels,
+    // but fit them again at least every MAX_LANDMARK_REUSE_FRAMES frames
+    const int MAX_LANDMARK_REUSE_SHIFT = 1;
+    const int MAX_LANDMARK_REUSE_FRAMES = 5;
+
+    // With motion in more than this ratio of tiles, the whole frame is searched again
+    const float MAX_PARTIAL_MOTION_RATIO = 0.5f;
+
+    std::thread detection_thread;
+    std::thread alignment_thread;
+    std::thread render_thread;
+
+    void detectionLoop();
+    void alignmentLoop();
+    void renderLoop();
+
+    std::shared_ptr<FaceDetector> getFaceDetector();
+    std::shared_ptr<FaceLandmarkDetector> getFaceLandmarkDetector();
+    std::vector<std::shared_ptr<ImageEffect>> getImageEffects();
+
+    void alignFaces(std::shared_ptr<FaceLandmarkDetector> detector,
+                    FrameContext & context, std::vector<LandMarkResult> & faces);
+    std::function<void()> getFrameReadyCallback();
+    std::function<void()> getCameraLostCallback();
+    std::shared_ptr<VideoRecorder> getVideoRecorder();
+    bool isAsyncDetection();
+    bool isFaceTracking();
+    bool isDetectionDue(uint64_t sequence, Timer::time_point_t now);
+    void markDetectionRun(uint64_t sequence, Timer::time_point_t now);
+    bool isROIDetection();
+    bool isFullScanDue(uint64_t sequence, Timer::time_point_t now);
+    void markFullScanRun(uint64_t sequence, Timer::time_point_t now);
+    bool isMotionGating(float & threshold);
+
+   public:
+    ProcessingPipeline(size_t queue_capacity = 2, DropPolicy drop_policy = DropPolicy::DropOldest);
+    ~ProcessingPipeline();
+
+    // Open camera and start all stages. Return false if camera cannot be opened.
+    // With native_yuv, frames stay in the camera's YUV layout: detectors and
+    // landmark fitters work on the Y plane, and BGR is only converted
+    // once, when a stage needs it or for rendering
+    bool start(int camera_index, bool native_yuv = false);
+
+    // Open any frame source and start all stages.
+    // Return false if the source cannot be opened
+    bool start(std::shared_ptr<FrameSource> source);
+    void stop();
+    bool isRunning();
+
+    // False after the capture stage lost the source (or it ran out of frames)
+    bool isSourceOpened();
+
+    // Policy used by all inter-stage queues when they are full
+    void setDropPolicy(DropPolicy drop_policy);
+
+    void setFlip(bool flip);
+    void setFaceDetector(std::shared_ptr<FaceDetector> detector);
+    void setFaceLandmarkDetector(std::shared_ptr<FaceLandmarkDetector> detector);
+    void setImageEffects(const std::vector<std::shared_ptr<ImageEffect>> & effects);
+
+    // In asynchronous mode every frame is rendered, while face detection runs
+    // in background on the frames chosen by detection schedule
+    void setAsyncDetection(bool async_detection);
+    void setDetectionSchedule(const DetectionSchedule & schedule);
+
+    // In ROI detection, the detector only searches around the faces of the
+    // last frame, so its cost scales with face area. The whole frame is
+    // still scanned on full_scan_schedule to find new faces (and whenever
+    // there is no face to search around)
+    void setROIDetection(bool roi_detection, const DetectionSchedule & full_scan_schedule);
+
+    // With motion gating, a due detection is skipped (and the last faces are
+    // reused) when the frame did not change since the last detection, and
+    // only runs on the changed regions when the motion is local.
+    // threshold is the mean absolute difference (in gray levels) of a tile
+    // of the downscaled frame for it to count as changed
+    void setMotionGating(bool motion_gating, float threshold = 4.0f);
+
+    // Track faces with optical flow on frames without a fresh detection.
+    // Detector then only needs to run to re-acquire faces
+    void setFaceTracking(bool face_tracking);
+
+    // Called from render thread every time a finished frame is ready.
+    // Use it to wake up the consumer instead of polling
+    void setFrameReadyCallback(std::function<void()> callback);
+
+    // Called from detection thread when the camera was lost
+    // or any other source ran out of frames
+    void setCameraLostCallback(std::function<void()> callback);
+
+    // Rendered frames are handed to this recorder (nullptr for none).
+    // It only keeps them while it is recording
+    void setVideoRecorder(std::shared_ptr<VideoRecorder> recorder);
+
+    // Take the next finished frame (frames come in capture order).
+    // Wait at most timeout miliseconds. Return false if no frame is ready
+    bool waitForFinishedFrame(FramePacketPtr & packet, Timer::time_duration_t timeout);
+
+    // Take the newest finished frame without waiting, dropping older ones.
+    // Return false if no frame is ready
+    bool takeLatestFinishedFrame(FramePacketPtr & packet);
+
+    std::shared_ptr<FrameBufferPool> getBufferPool();
+
+    // Number of frames which went through every stage since start
+    uint64_t getRenderedFrameCount();
+
+    // Number of camera frames the detection stage never took
+    uint64_t getCaptureDroppedFrameCount();
+
+    // Total number of frames dropped by capture and between stages
+    uint64_t getDroppedFrameCount();
+
+    // Ratio of due detector runs skipped by motion gating (0 - 1), and of
+    // runs limited to changed regions
+    float getDetectionSkipRatio();
+    float getPartialDetectionRatio();
+};
+
+}  // namespace ml_cam
+
+#endif  // PROCESSING_PIPELINE_H
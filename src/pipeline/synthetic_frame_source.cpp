@@ -0,0 +1,117 @@
+#include "synthetic_frame_source.h"
+
+#include <algorithm>
+
+using namespace ml_cam;
+
+SyntheticFrameSource::SyntheticFrameSource(cv::Size resolution, double frame_rate,
+                                           int num_faces, const std::string & sprite_path,
+                                           uint64_t max_frames)
+    : resolution(resolution),
+      frame_rate(frame_rate),
+      num_faces(num_faces),
+      sprite_path(sprite_path),
+      max_frames(max_frames) {}
+
+SyntheticFrameSource::~SyntheticFrameSource() { close(); }
+
+bool SyntheticFrameSource::openSource() {
+    if (resolution.width <= 0 || resolution.height <= 0) {
+        return false;
+    }
+
+    sprite.release();
+    if (!sprite_path.empty()) {
+        sprite = cv::imread(sprite_path, cv::IMREAD_COLOR);
+        if (sprite.empty()) {
+            return false;
+        }
+    }
+
+    // Vertical gradient, so the frame is not completely flat
+    background.create(resolution, CV_8UC3);
+    for (int y = 0; y < resolution.height; ++y) {
+        uchar value = static_cast<uchar>(60 + 120 * y / resolution.height);
+        background.row(y).setTo(cv::Scalar(value, value * 0.9, value * 0.8));
+    }
+
+    // Fixed seed, so every run generates the same frames
+    cv::RNG rng(12345);
+    int min_side = std::min(resolution.width, resolution.height);
+    faces.clear();
+    for (int i = 0; i < num_faces; ++i) {
+        MovingFace face;
+        face.size = std::max(16, rng.uniform(min_side / 5, min_side / 3 + 1));
+        face.position.x = rng.uniform(0, std::max(1, resolution.width - face.size));
+        face.position.y = rng.uniform(0, std::max(1, resolution.height - face.size));
+        face.velocity.x = rng.uniform(-4.0, 4.0);
+        face.velocity.y = rng.uniform(-3.0, 3.0);
+        faces.push_back(face);
+    }
+
+    generated_frames = 0;
+    return true;
+}
+
+void SyntheticFrameSource::closeSource() {}
+
+bool SyntheticFrameSource::readFrame(cv::Mat & frame) {
+    ++generated_frames;
+
+    // Draw into the given buffer. Consumers may still hold the previous frame,
+    // but never this one
+    background.copyTo(frame);
+
+    for (MovingFace & face : faces) {
+        drawFace(frame, face);
+
+        // Bounce off the frame borders
+        face.position += face.velocity;
+        if (face.position.x < 0 || face.position.x + face.size > resolution.width) {
+            face.velocity.x = -face.velocity.x;
+            face.position.x = std::min(std::max(face.position.x, 0.0),
+                                       static_cast<double>(resolution.width - face.size));
+        }
+        if (face.position.y < 0 || face.position.y + face.size > resolution.height) {
+            face.velocity.y = -face.velocity.y;
+            face.position.y = std::min(std::max(face.position.y, 0.0),
+                                       static_cast<double>(resolution.height - face.size));
+        }
+    }
+
+    return true;
+}
+
+void SyntheticFrameSource::drawFace(cv::Mat & frame, const MovingFace & face) {
+    cv::Rect face_rect(static_cast<int>(face.position.x), static_cast<int>(face.position.y),
+                       face.size, face.size);
+    face_rect &= cv::Rect(0, 0, frame.cols, frame.rows);
+    if (face_rect.area() == 0) {
+        return;
+    }
+
+    if (!sprite.empty()) {
+        cv::Mat resized;
+        cv::resize(sprite, resized, cv::Size(face.size, face.size));
+        resized(cv::Rect(0, 0, face_rect.width, face_rect.height)).copyTo(frame(face_rect));
+        return;
+    }
+
+    // Simple face: skin colored ellipse with eyes and mouth
+    cv::Point center(face_rect.x + face.size / 2, face_rect.y + face.size / 2);
+    int s = face.size;
+    cv::ellipse(frame, center, cv::Size(s * 2 / 5, s / 2), 0, 0, 360,
+                cv::Scalar(140, 170, 225), cv::FILLED, cv::LINE_AA);
+    cv::circle(frame, center + cv::Point(-s / 6, -s / 8), std::max(2, s / 14),
+               cv::Scalar(40, 30, 30), cv::FILLED, cv::LINE_AA);
+    cv::circle(frame, center + cv::Point(s / 6, -s / 8), std::max(2, s / 14),
+               cv::Scalar(40, 30, 30), cv::FILLED, cv::LINE_AA);
+    cv::ellipse(frame, center + cv::Point(0, s / 5), cv::Size(s / 6, s / 14), 0, 0, 180,
+                cv::Scalar(60, 60, 150), std::max(1, s / 40), cv::LINE_AA);
+}
+
+bool SyntheticFrameSource::hasMoreFrames() {
+    return max_frames == 0 || generated_frames < max_frames;
+}
+
+double SyntheticFrameSource::getFrameRate() { return frame_rate; }
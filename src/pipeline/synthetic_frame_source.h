@@ -0,0 +1,56 @@
+#if !defined(SYNTHETIC_FRAME_SOURCE_H)
+#define SYNTHETIC_FRAME_SOURCE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+namespace ml_cam {
+
+// Generated frames with face sprites moving around on a static background.
+// Resolution, frame rate and number of faces are configurable, so the
+// pipeline can be measured without a camera or test footage.
+// Sprite image is used as face if given, otherwise a simple face is drawn.
+// The source ends after max_frames frames (0 means never)
+class SyntheticFrameSource : public FrameSource {
+   private:
+    struct MovingFace {
+        cv::Point2d position;  // Top left corner
+        cv::Point2d velocity;  // Pixels per frame
+        int size;
+    };
+
+    cv::Size resolution;
+    double frame_rate;
+    int num_faces;
+    std::string sprite_path;
+    uint64_t max_frames;
+
+    // Used by capture thread only
+    uint64_t generated_frames = 0;
+    cv::Mat background;
+    cv::Mat sprite;
+    std::vector<MovingFace> faces;
+
+    void drawFace(cv::Mat & frame, const MovingFace & face);
+
+   protected:
+    bool openSource();
+    void closeSource();
+    bool readFrame(cv::Mat & frame);
+    bool hasMoreFrames();
+    double getFrameRate();
+
+   public:
+    SyntheticFrameSource(cv::Size resolution = cv::Size(640, 480), double frame_rate = 30,
+                         int num_faces = 1, const std::string & sprite_path = "",
+                         uint64_t max_frames = 0);
+    ~SyntheticFrameSource();
+};
+
+}  // namespace ml_cam
+
+#endif  // SYNTHETIC_FRAME_SOURCE_H
@@ -0,0 +1,61 @@
+#include "video_file_frame_source.h"
+
+using namespace ml_cam;
+
+VideoFileFrameSource::VideoFileFrameSource(const std::string & path, bool loop)
+    : path(path), loop(loop) {}
+
+VideoFileFrameSource::~VideoFileFrameSource() { close(); }
+
+bool VideoFileFrameSource::openSource() {
+    if (!video.open(path)) {
+        return false;
+    }
+
+    // Some containers do not report their frame rate
+    frame_rate = video.get(cv::CAP_PROP_FPS);
+    if (frame_rate <= 0) {
+        frame_rate = DEFAULT_FRAME_RATE;
+    }
+
+    finished = false;
+    return true;
+}
+
+void VideoFileFrameSource::closeSource() {
+    if (video.isOpened()) {
+        video.release();
+    }
+}
+
+bool VideoFileFrameSource::readFrame(cv::Mat & frame) {
+    if (video.read(frame)) {
+        return true;
+    }
+
+    // End of file
+    if (!loop) {
+        finished = true;
+        return false;
+    }
+
+    // Rewinding is not supported by every backend, so reopen if it fails
+    if (!video.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+        video.release();
+        if (!video.open(path)) {
+            finished = true;
+            return false;
+        }
+    }
+
+    if (!video.read(frame)) {
+        // Empty or broken file
+        finished = true;
+        return false;
+    }
+    return true;
+}
+
+bool VideoFileFrameSource::hasMoreFrames() { return video.isOpened() && !finished; }
+
+double VideoFileFrameSource::getFrameRate() { return frame_rate; }
@@ -0,0 +1,38 @@
+#if !defined(VIDEO_FILE_FRAME_SOURCE_H)
+#define VIDEO_FILE_FRAME_SOURCE_H
+
+#include <atomic>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+namespace ml_cam {
+
+// Frames decoded from a video file, played at the file's frame rate.
+// When loop is set, the video starts again from the beginning at its end
+class VideoFileFrameSource : public FrameSource {
+   private:
+    std::string path;
+    bool loop;
+    cv::VideoCapture video;
+    double frame_rate = 0;
+    std::atomic<bool> finished{false};
+
+    static constexpr double DEFAULT_FRAME_RATE = 30;
+
+   protected:
+    bool openSource();
+    void closeSource();
+    bool readFrame(cv::Mat & frame);
+    bool hasMoreFrames();
+    double getFrameRate();
+
+   public:
+    VideoFileFrameSource(const std::string & path, bool loop = true);
+    ~VideoFileFrameSource();
+};
+
+}  // namespace ml_cam
+
+#endif  // VIDEO_FILE_FRAME_SOURCE_H
@@ -0,0 +1,124 @@
+#include "video_recorder.h"
+
+#include <iostream>
+
+using namespace ml_cam;
+
+VideoRecorder::VideoRecorder(size_t queue_capacity, DropPolicy drop_policy)
+    : frame_queue(queue_capacity, drop_policy) {
+    // Refuse frames until recording starts
+    frame_queue.close();
+}
+
+VideoRecorder::~VideoRecorder() {
+    stop();
+    if (encoder_thread.joinable()) {
+        encoder_thread.join();
+    }
+}
+
+int VideoRecorder::parseCodec(const std::string & codec) {
+    if (codec.size() != 4) {
+        return -1;
+    }
+    return cv::VideoWriter::fourcc(codec[0], codec[1], codec[2], codec[3]);
+}
+
+std::string VideoRecorder::getFileExtension(const std::string & codec) {
+    if (codec == "mp4v" || codec == "avc1" || codec == "H264" || codec == "X264") {
+        return ".mp4";
+    }
+    return ".avi";
+}
+
+bool VideoRecorder::start(const fs::path & path, const std::string & codec, double fps) {
+    int fourcc = parseCodec(codec);
+    if (fourcc == -1) {
+        std::cerr << "Invalid video codec: " << codec << std::endl;
+        return false;
+    }
+
+    stop();
+
+    // Let the previous recording finish writing its queued frames
+    if (encoder_thread.joinable()) {
+        encoder_thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        this->path = path;
+        dropped_count_at_start = frame_queue.getDroppedCount();
+    }
+    written_frame_count = 0;
+    recording = true;
+
+    frame_queue.reopen();
+    encoder_thread = std::thread(&VideoRecorder::encoderLoop, this, path, fourcc, fps > 0 ? fps : 30);
+    return true;
+}
+
+void VideoRecorder::stop() {
+    recording = false;
+    frame_queue.close();
+}
+
+bool VideoRecorder::isRecording() { return recording; }
+
+void VideoRecorder::addFrame(const cv::Mat & frame) {
+    if (!recording || frame.empty()) {
+        return;
+    }
+    frame_queue.push(frame);
+}
+
+void VideoRecorder::setDropPolicy(DropPolicy drop_policy) {
+    frame_queue.setDropPolicy(drop_policy);
+}
+
+fs::path VideoRecorder::getPath() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return path;
+}
+
+size_t VideoRecorder::getQueueDepth() { return frame_queue.size(); }
+
+uint64_t VideoRecorder::getDroppedFrameCount() {
+    std::lock_guard<std::mutex> guard(mutex);
+    return frame_queue.getDroppedCount() - dropped_count_at_start;
+}
+
+uint64_t VideoRecorder::getWrittenFrameCount() { return written_frame_count; }
+
+void VideoRecorder::encoderLoop(fs::path path, int fourcc, double fps) {
+    cv::VideoWriter writer;
+    cv::Size frame_size;
+    cv::Mat resized;
+
+    cv::Mat frame;
+    while (frame_queue.pop(frame)) {
+        // Open the file with the size of the first frame
+        if (!writer.isOpened()) {
+            frame_size = frame.size();
+            if (!writer.open(path.string(), fourcc, fps, frame_size, true)) {
+                std::cerr << "Could not open video file: " << path << std::endl;
+                stop();
+                break;
+            }
+        }
+
+        // Frame size changes when camera is changed
+        if (frame.size() != frame_size) {
+            cv::resize(frame, resized, frame_size);
+            writer.write(resized);
+        } else {
+            writer.write(frame);
+        }
+        ++written_frame_count;
+
+        // Release the frame so that its buffer can be recycled
+        frame.release();
+    }
+
+    writer.release();
+}
@@ -0,0 +1,71 @@
+#if !defined(VIDEO_RECORDER_H)
+#define VIDEO_RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <opencv2/opencv.hpp>
+
+#include "bounded_queue.h"
+#include "filesystem_include.h"
+
+namespace ml_cam {
+
+// Record frames to a video file. Frames are encoded by cv::VideoWriter on a
+// dedicated encoder thread, fed by a bounded queue. When the encoder falls
+// behind, frames are dropped according to the drop policy, so the producer
+// (render stage) never waits for the encoder.
+class VideoRecorder {
+   private:
+    BoundedQueue<cv::Mat> frame_queue;
+    std::thread encoder_thread;
+
+    std::mutex mutex;
+    fs::path path;
+    size_t dropped_count_at_start = 0;  // The queue counts dropped frames of all recordings
+
+    std::atomic<bool> recording{false};
+    std::atomic<uint64_t> written_frame_count{0};
+
+    void encoderLoop(fs::path path, int fourcc, double fps);
+
+   public:
+    VideoRecorder(size_t queue_capacity = 60, DropPolicy drop_policy = DropPolicy::DropNewest);
+
+    // Write queued frames and close the file
+    ~VideoRecorder();
+
+    // FourCC code of a codec name like "MJPG" or "mp4v". Return -1 if the name is not 4 characters
+    static int parseCodec(const std::string & codec);
+
+    // File extension (with the dot) of the usual container for a codec
+    static std::string getFileExtension(const std::string & codec);
+
+    // Start recording to path. The video file is opened when the first
+    // frame comes, with the size of that frame.
+    // Return false if the codec is invalid
+    bool start(const fs::path & path, const std::string & codec, double fps);
+
+    // Stop taking frames. Queued frames are still written in background
+    void stop();
+
+    // False after stop(), or when the video file could not be opened
+    bool isRecording();
+
+    // Queue a frame to be written. The frame is not copied, so it must not
+    // be modified after being added. Does nothing when not recording
+    void addFrame(const cv::Mat & frame);
+
+    void setDropPolicy(DropPolicy drop_policy);
+
+    fs::path getPath();
+    size_t getQueueDepth();
+    uint64_t getDroppedFrameCount();
+    uint64_t getWrittenFrameCount();
+};
+
+}  // namespace ml_cam
+
+#endif  // VIDEO_RECORDER_H
@@ -0,0 +1,47 @@
+#include "sound_player.h"
+
+#include <iostream>
+
+using namespace ml_cam;
+
+SoundPlayer::SoundPlayer(const std::string & wav_path) {
+    SDL_AudioSpec wav_spec;
+    if (SDL_LoadWAV(wav_path.c_str(), &wav_spec, &wav_buffer, &wav_length) == NULL) {
+        std::cerr << "Could not load sound " << wav_path << ": " << SDL_GetError() << std::endl;
+        wav_buffer = nullptr;
+        return;
+    }
+
+    // Device uses the format of the sound, so queued samples need no conversion
+    device_id = SDL_OpenAudioDevice(NULL, 0, &wav_spec, NULL, 0);
+    if (device_id == 0) {
+        std::cerr << "Could not open audio device: " << SDL_GetError() << std::endl;
+        return;
+    }
+
+    // Device stays unpaused and plays whatever is queued
+    SDL_PauseAudioDevice(device_id, 0);
+}
+
+SoundPlayer::~SoundPlayer() {
+    if (device_id != 0) {
+        SDL_CloseAudioDevice(device_id);
+    }
+    if (wav_buffer != nullptr) {
+        SDL_FreeWAV(wav_buffer);
+    }
+}
+
+bool SoundPlayer::isReady() { return device_id != 0 && wav_buffer != nullptr; }
+
+void SoundPlayer::play() {
+    if (!isReady()) {
+        return;
+    }
+
+    // Restart: drop what is left of the previous play
+    SDL_ClearQueuedAudio(device_id);
+    if (SDL_QueueAudio(device_id, wav_buffer, wav_length) != 0) {
+        std::cerr << "Could not play sound: " << SDL_GetError() << std::endl;
+    }
+}
@@ -0,0 +1,36 @@
+#if !defined(SOUND_PLAYER_H)
+#define SOUND_PLAYER_H
+
+#include <string>
+#include <SDL.h>
+
+namespace ml_cam {
+
+// Play a short WAV sound without blocking.
+// The sound is decoded once and one audio device is kept open, so play()
+// only queues the samples. Playing again while the sound is still playing
+// restarts it.
+// SDL audio must be initialized first. With SDL_AUDIODRIVER=dummy it works
+// without sound hardware.
+class SoundPlayer {
+   private:
+    SDL_AudioDeviceID device_id = 0;
+    Uint8 *wav_buffer = nullptr;
+    Uint32 wav_length = 0;
+
+   public:
+    SoundPlayer(const std::string & wav_path);
+    ~SoundPlayer();
+
+    SoundPlayer(const SoundPlayer &) = delete;
+    SoundPlayer & operator=(const SoundPlayer &) = delete;
+
+    // False if the sound could not be loaded or no audio device could be opened
+    bool isReady();
+
+    void play();
+};
+
+}  // namespace ml_cam
+
+#endif  // SOUND_PLAYER_H
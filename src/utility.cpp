@@ -1,4 +1,6 @@
 #include "utility.h"
+#include <fstream>
+#include <iterator>
 
 
 namespace ml_cam {
@@ -47,6 +49,12 @@ void setLabel(cv::Mat &im, const std::string label, const cv::Point &origin) {
                 thickness, 8);
 }
 
+float calcIoU(const cv::Rect & a, const cv::Rect & b) {
+    int intersection = (a & b).area();
+    int union_area = a.area() + b.area() - intersection;
+    return union_area <= 0 ? 0 : static_cast<float>(intersection) / union_area;
+}
+
 std::string getHomePath() {
     char *pValue;
     char *pValue2;
@@ -82,6 +90,17 @@ std::string getHomePath() {
     return "";
 }
 
+std::shared_ptr<const std::vector<uchar>> readFileBuffer(const std::string & path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+
+    std::shared_ptr<std::vector<uchar>> buffer = std::make_shared<std::vector<uchar>>(
+        (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return buffer;
+}
+
 QImage Mat2QImage(cv::Mat const &src) {
     cv::Mat temp;  // make the same cv::Mat
     cvtColor(src, temp,
@@ -4,6 +4,8 @@
 #include <opencv2/opencv.hpp>
 #include <stdlib.h>
 #include <iostream>
+#include <memory>
+#include <vector>
 #include <QImage>
 
 namespace ml_cam {
@@ -11,6 +13,12 @@ namespace ml_cam {
     void setLabel(cv::Mat& im, const std::string label, const cv::Point & origin);
     std::string getHomePath();
 
+    // Read whole file into memory. Return nullptr if it cannot be read
+    std::shared_ptr<const std::vector<uchar>> readFileBuffer(const std::string & path);
+
+    // Intersection over union of two boxes. 0 when they do not overlap
+    float calcIoU(const cv::Rect & a, const cv::Rect & b);
+
     QImage Mat2QImage(cv::Mat const& src);
     cv::Mat QImage2Mat(QImage const& src);
 